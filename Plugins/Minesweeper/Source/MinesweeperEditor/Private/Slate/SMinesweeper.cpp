@@ -28,6 +28,7 @@ void SMinesweeper::Construct(const FArguments& InArgs)
 
 
 	Game = TStrongObjectPtr<UMinesweeperGame>(NewObject<UMinesweeperGame>(GetTransientPackage()));
+	Game->OnBoardChanged.AddSP(this, &SMinesweeper::OnBoardChanged);
 	SetCellDrawSize(InArgs._CellDrawSize);
 
 
@@ -59,11 +60,15 @@ void SMinesweeper::Construct(const FArguments& InArgs)
 			[
 				SNew(SBorder)
 				[
-					SNew(SMinesweeperGrid)
+					SAssignNew(GridWidget, SMinesweeperGrid)
 					.GridCanvasBrush(&GridCanvasBrush)
+					.HoverCellBrush(&HoverCellBrush)
+					.CellDrawSize(this, &SMinesweeper::GetCellDrawSize)
 					.OnCellLeftClick(this, &SMinesweeper::OnCellLeftClick)
 					.OnCellRightClick(this, &SMinesweeper::OnCellRightClick)
+					.OnCellChordClick(this, &SMinesweeper::OnCellChordClick)
 					.OnHoverCellChanged(this, &SMinesweeper::OnHoverCellChanged)
+					.OnGridScroll(this, &SMinesweeper::OnGridScroll)
 				]
 			]
 			+ SOverlay::Slot()
@@ -248,13 +253,16 @@ bool SMinesweeper::IsGameActive() const
 void SMinesweeper::StartNewGame(const FMinesweeperDifficulty& InDifficulty)
 {
 	Game->SetupGame(InDifficulty);
+	GridCanvas->SetViewOrigin(0, 0);
 	SetGridSize(InDifficulty.GridSize());
+	UpdateHoverOutline();
 }
 
 void SMinesweeper::RestartGame()
 {
 	Game->RestartGame();
 	GridCanvas->UpdateResource();
+	UpdateHoverOutline();
 }
 
 void SMinesweeper::PauseGame()
@@ -275,7 +283,7 @@ FText SMinesweeper::GetTimerText() const
 
 const FSlateBrush* SMinesweeper::GetSmileImage() const
 {
-	return FMinesweeperStyle::GetBrush((Game->IsGameActive() || Game->GetGameTime() == 0.0f || Game->HasWon()) ? "MrSmile.Alive" : "MrSmile.Dead");
+	return FMinesweeperStyle::GetBrush((!Game->IsGameOver() || Game->HasWon()) ? "MrSmile.Alive" : "MrSmile.Dead");
 }
 
 FText SMinesweeper::GetFlagsRemainingText() const
@@ -285,7 +293,7 @@ FText SMinesweeper::GetFlagsRemainingText() const
 
 EVisibility SMinesweeper::GetWinLoseVisibility() const
 {
-	return (!Game->IsGameActive() && Game->GetGameTime() > 0.0f) ? EVisibility::SelfHitTestInvisible : EVisibility::Hidden;
+	return Game->IsGameOver() ? EVisibility::SelfHitTestInvisible : EVisibility::Hidden;
 }
 
 FSlateColor SMinesweeper::GetWinLoseColor() const
@@ -327,7 +335,10 @@ FReply SMinesweeper::OnGameSetupButtonClick()
 void SMinesweeper::SetGridSize(const FIntVector2& InGridSize, const float InNewCellDrawSize)
 {
 	const float cellDrawSize = FMath::Clamp(InNewCellDrawSize > -1.0f ? InNewCellDrawSize : GetCellDrawSize(), 10.0f, 64.0f);
-	FVector2D gridCanvasSize(InGridSize.X * cellDrawSize, InGridSize.Y * cellDrawSize);
+
+	// large grids only draw a scrollable window of cells
+	const FIntVector2 viewCellCount = UMinesweeperGridCanvas::ComputeViewCellCount(InGridSize, cellDrawSize);
+	FVector2D gridCanvasSize(viewCellCount.X * cellDrawSize, viewCellCount.Y * cellDrawSize);
 
 	if (!GridCanvas.IsValid())
 	{
@@ -347,6 +358,9 @@ void SMinesweeper::SetGridSize(const FIntVector2& InGridSize, const float InNewC
 
 		GridCanvasBrush.SetResourceObject(GridCanvas.Get());
 		GridCanvasBrush.TintColor = FLinearColor::White;
+
+		HoverCellBrush.SetResourceObject(GridCanvas->GetHoverCellTexture());
+		HoverCellBrush.TintColor = FLinearColor::White;
 	}
 	else
 	{
@@ -354,6 +368,7 @@ void SMinesweeper::SetGridSize(const FIntVector2& InGridSize, const float InNewC
 	}
 
 	GridCanvasBrush.SetImageSize(gridCanvasSize);
+	HoverCellBrush.SetImageSize(FVector2D(cellDrawSize));
 
 	GridCanvas->InitCanvas(Game.Get(), cellDrawSize);
 }
@@ -378,8 +393,6 @@ void SMinesweeper::OnCellLeftClick(const FVector2D& InGridPosition)
 	GridCanvas->GridPositionToCellCoord(InGridPosition, cellCoord.X, cellCoord.Y);
 
 	Game->TryOpenCell(cellCoord.X, cellCoord.Y);
-
-	GridCanvas->UpdateResource();
 }
 
 void SMinesweeper::OnCellRightClick(const FVector2D& InGridPosition)
@@ -389,23 +402,75 @@ void SMinesweeper::OnCellRightClick(const FVector2D& InGridPosition)
 	FIntVector2 cellCoord;
 	GridCanvas->GridPositionToCellCoord(InGridPosition, cellCoord.X, cellCoord.Y);
 
-	Game->TryFlagCall(cellCoord.X, cellCoord.Y);
+	Game->TryFlagCell(cellCoord.X, cellCoord.Y);
+}
 
-	GridCanvas->UpdateResource();
+void SMinesweeper::OnCellChordClick(const FVector2D& InGridPosition)
+{
+	if (!GridCanvas.IsValid()) return;
+
+	FIntVector2 cellCoord;
+	GridCanvas->GridPositionToCellCoord(InGridPosition, cellCoord.X, cellCoord.Y);
+
+	// every neighbor is revealed by the one call, so OnBoardChanged redraws the canvas once
+	Game->TryChordCell(cellCoord.X, cellCoord.Y);
+}
+
+void SMinesweeper::OnBoardChanged()
+{
+	if (!GridCanvas.IsValid()) return;
+
+	// only the cells the action changed are drawn again
+	GridCanvas->RedrawChangedCells();
+
+	// the hovered cell may have been opened
+	UpdateHoverOutline();
 }
 
 void SMinesweeper::OnHoverCellChanged(const bool InIsHovered, const FVector2D& InGridPosition)
 {
 	if (!GridCanvas.IsValid()) return;
 
+	bHasHoverCell = InIsHovered;
 	if (InIsHovered)
-		GridCanvas->SetHoverCellIndex(GridCanvas->GridPositionToCellIndex(InGridPosition));
-	else
-		GridCanvas->ClearHoverCell();
+	{
+		GridCanvas->GridPositionToCellCoord(InGridPosition, HoverCellCoord.X, HoverCellCoord.Y);
+	}
+
+	// the outline is painted by the grid widget, the canvas is not redrawn
+	UpdateHoverOutline();
+}
+
+void SMinesweeper::OnGridScroll(const FIntVector2& InScrollCells)
+{
+	if (!GridCanvas.IsValid()) return;
+
+	FIntVector2 viewOrigin;
+	GridCanvas->GetViewOrigin(viewOrigin.X, viewOrigin.Y);
+	GridCanvas->SetViewOrigin(viewOrigin.X + InScrollCells.X, viewOrigin.Y + InScrollCells.Y);
 
 	GridCanvas->UpdateResource();
 }
 
+void SMinesweeper::UpdateHoverOutline()
+{
+	if (!GridWidget.IsValid() || !GridCanvas.IsValid()) return;
+
+	if (!bHasHoverCell || !Game->IsValidGridCoord((int64)HoverCellCoord.X, (int64)HoverCellCoord.Y))
+	{
+		GridWidget->ClearHoverOutline();
+		return;
+	}
+
+	FIntVector2 viewOrigin;
+	GridCanvas->GetViewOrigin(viewOrigin.X, viewOrigin.Y);
+
+	const float cellDrawSize = GridCanvas->GetCellDrawSize();
+	const FVector2D cellPosition((HoverCellCoord.X - viewOrigin.X) * cellDrawSize, (HoverCellCoord.Y - viewOrigin.Y) * cellDrawSize);
+
+	GridWidget->SetHoverOutline(cellPosition, GridCanvas->GetHoverCellColor(HoverCellCoord.X, HoverCellCoord.Y));
+}
+
 
 
 
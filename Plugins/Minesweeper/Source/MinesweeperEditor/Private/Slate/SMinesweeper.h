@@ -70,6 +70,13 @@ private:
 	TStrongObjectPtr<UMinesweeperGridCanvas> GridCanvas;
 	FSlateBrush GridCanvasBrush;
 
+	/** Grid widget, which paints the hover outline over the canvas. */
+	TSharedPtr<SMinesweeperGrid> GridWidget;
+	FSlateBrush HoverCellBrush;
+
+	bool bHasHoverCell = false;
+	FIntVector2 HoverCellCoord = FIntVector2(0, 0);
+
 
 	FSimpleDelegate OnGameSetupClick;
 	FMinesweeperGameOverHighScoreDelegate OnGameOver;
@@ -93,7 +100,15 @@ private:
 
 	void OnCellLeftClick(const FVector2D& InGridPosition);
 	void OnCellRightClick(const FVector2D& InGridPosition);
+	void OnCellChordClick(const FVector2D& InGridPosition);
+
+	/** Redraws the canvas once per game action, or once per ApplyActions batch. */
+	void OnBoardChanged();
 	void OnHoverCellChanged(const bool InIsHovered, const FVector2D& InGridPosition);
+	void OnGridScroll(const FIntVector2& InScrollCells);
+
+	/** Moves the hover outline of the grid widget to the hovered cell, colored by whether the cell can still be opened. */
+	void UpdateHoverOutline();
 
 };
 
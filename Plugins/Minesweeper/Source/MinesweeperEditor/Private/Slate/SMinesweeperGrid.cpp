@@ -13,7 +13,11 @@ void SMinesweeperGrid::Construct(const FArguments& InArgs)
 {
 	OnCellLeftClick = InArgs._OnCellLeftClick;
 	OnCellRightClick = InArgs._OnCellRightClick;
+	OnCellChordClick = InArgs._OnCellChordClick;
 	OnHoverCellChanged = InArgs._OnHoverCellChanged;
+	OnGridScroll = InArgs._OnGridScroll;
+	HoverCellBrush = InArgs._HoverCellBrush;
+	CellDrawSize = InArgs._CellDrawSize;
 
 	SImage::Construct(
 		SImage::FArguments().Image(InArgs._GridCanvasBrush)
@@ -36,7 +40,13 @@ FReply SMinesweeperGrid::OnMouseButtonDown(const FGeometry& InMyGeometry, const
 {
 	const FVector2D localMousePosition = InMyGeometry.AbsoluteToLocal(InMouseEvent.GetScreenSpacePosition());
 
-	if (InMouseEvent.IsMouseButtonDown(EKeys::LeftMouseButton))
+	// the first of a left and right press already opened or flagged the cell, which does nothing to the opened cells a chord targets
+	const bool bIsLeftAndRightDown = InMouseEvent.IsMouseButtonDown(EKeys::LeftMouseButton) && InMouseEvent.IsMouseButtonDown(EKeys::RightMouseButton);
+	if (InMouseEvent.GetEffectingButton() == EKeys::MiddleMouseButton || bIsLeftAndRightDown)
+	{
+		OnCellChordClick.ExecuteIfBound(localMousePosition);
+	}
+	else if (InMouseEvent.IsMouseButtonDown(EKeys::LeftMouseButton))
 	{
 		OnCellLeftClick.ExecuteIfBound(localMousePosition);
 	}
@@ -56,11 +66,15 @@ FReply SMinesweeperGrid::OnMouseButtonUp(const FGeometry& InMyGeometry, const FP
 void SMinesweeperGrid::OnMouseEnter(const FGeometry& InMyGeometry, const FPointerEvent& InMouseEvent)
 {
 	const FVector2D localMousePosition = InMyGeometry.AbsoluteToLocal(InMouseEvent.GetScreenSpacePosition());
+	LastHoverCell = GridPositionToHoverCell(localMousePosition);
+
 	OnHoverCellChanged.ExecuteIfBound(true, localMousePosition);
 }
 
 void SMinesweeperGrid::OnMouseLeave(const FPointerEvent& InMouseEvent)
 {
+	LastHoverCell = FIntPoint(INDEX_NONE, INDEX_NONE);
+
 	OnHoverCellChanged.ExecuteIfBound(false, FVector2D::ZeroVector);
 }
 
@@ -69,11 +83,81 @@ FReply SMinesweeperGrid::OnMouseMove(const FGeometry& InMyGeometry, const FPoint
 	const FVector2D localMousePosition = InMyGeometry.AbsoluteToLocal(InMouseEvent.GetScreenSpacePosition());
 	//UE_LOG(LogMinesweeperEditor, Log, TEXT("%s"), *localMousePosition.ToString());
 
+	// most mouse moves stay inside the hovered cell
+	const FIntPoint hoverCell = GridPositionToHoverCell(localMousePosition);
+	if (hoverCell == LastHoverCell) return FReply::Handled();
+
+	LastHoverCell = hoverCell;
+	OnHoverCellChanged.ExecuteIfBound(true, localMousePosition);
+
+	return FReply::Handled();
+}
+
+FReply SMinesweeperGrid::OnMouseWheel(const FGeometry& InMyGeometry, const FPointerEvent& InMouseEvent)
+{
+	if (!OnGridScroll.IsBound()) return FReply::Unhandled();
+
+	const int32 cellsPerNotch = 3;
+	const int32 scrollCells = -FMath::RoundToInt32(InMouseEvent.GetWheelDelta() * cellsPerNotch);
+	if (scrollCells == 0) return FReply::Handled();
+
+	OnGridScroll.Execute(InMouseEvent.IsShiftDown() ? FIntVector2(scrollCells, 0) : FIntVector2(0, scrollCells));
+
+	// the cell under the mouse changes with the view
+	const FVector2D localMousePosition = InMyGeometry.AbsoluteToLocal(InMouseEvent.GetScreenSpacePosition());
+	LastHoverCell = GridPositionToHoverCell(localMousePosition);
 	OnHoverCellChanged.ExecuteIfBound(true, localMousePosition);
 
 	return FReply::Handled();
 }
 
+int32 SMinesweeperGrid::OnPaint(const FPaintArgs& InArgs, const FGeometry& InAllottedGeometry, const FSlateRect& InMyCullingRect, FSlateWindowElementList& OutDrawElements, int32 InLayerId, const FWidgetStyle& InWidgetStyle, bool bInParentEnabled) const
+{
+	int32 layerId = SImage::OnPaint(InArgs, InAllottedGeometry, InMyCullingRect, OutDrawElements, InLayerId, InWidgetStyle, bInParentEnabled);
+
+	if (bHasHoverOutline && HoverCellBrush)
+	{
+		++layerId;
+		FSlateDrawElement::MakeBox(
+			OutDrawElements,
+			layerId,
+			InAllottedGeometry.ToPaintGeometry(HoverOutlinePosition, FVector2D(CellDrawSize.Get())),
+			HoverCellBrush,
+			ESlateDrawEffect::None,
+			HoverOutlineColor * InWidgetStyle.GetColorAndOpacityTint());
+	}
+
+	return layerId;
+}
+
+
+void SMinesweeperGrid::SetHoverOutline(const FVector2D& InCellPosition, const FLinearColor& InColor)
+{
+	if (bHasHoverOutline && HoverOutlinePosition == InCellPosition && HoverOutlineColor == InColor) return;
+
+	bHasHoverOutline = true;
+	HoverOutlinePosition = InCellPosition;
+	HoverOutlineColor = InColor;
+
+	// only this widget is painted again, the grid canvas texture is left as it is
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SMinesweeperGrid::ClearHoverOutline()
+{
+	if (!bHasHoverOutline) return;
+
+	bHasHoverOutline = false;
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+
+FIntPoint SMinesweeperGrid::GridPositionToHoverCell(const FVector2D& InGridPosition) const
+{
+	const float cellDrawSize = FMath::Max(CellDrawSize.Get(1.0f), 1.0f);
+	return FIntPoint(FMath::FloorToInt32(InGridPosition.X / cellDrawSize), FMath::FloorToInt32(InGridPosition.Y / cellDrawSize));
+}
+
 
 
 
@@ -9,10 +9,12 @@
 
 DECLARE_DELEGATE_OneParam(FMinesweeperGridPositionDelegate, const FVector2D&);
 DECLARE_DELEGATE_TwoParams(FMinesweeperGridHoverPositionDelegate, const bool, const FVector2D&);
+DECLARE_DELEGATE_OneParam(FMinesweeperGridScrollDelegate, const FIntVector2&);
 
 
 /**
  * SMinesweeperGrid - Visual representation of a Minesweeper grid.
+ * The hover outline is painted by the widget on top of the grid canvas, so moving the mouse never redraws the canvas.
  */
 class SMinesweeperGrid : public SImage
 {
@@ -24,16 +26,33 @@ public:
 
 		SLATE_EVENT(FMinesweeperGridPositionDelegate, OnCellRightClick)
 
+		/** Called on a middle click, or when the second of the left and right buttons goes down while the other is held. */
+		SLATE_EVENT(FMinesweeperGridPositionDelegate, OnCellChordClick)
+
+		/** Called when the mouse enters or leaves the grid and whenever it moves to another cell, not on every mouse move. */
 		SLATE_EVENT(FMinesweeperGridHoverPositionDelegate, OnHoverCellChanged)
+
+		/** Called with the number of cells to scroll the view by, vertically with the mouse wheel and horizontally with shift held. */
+		SLATE_EVENT(FMinesweeperGridScrollDelegate, OnGridScroll)
 	
 		SLATE_ARGUMENT(const FSlateBrush*, GridCanvasBrush)
 
+		SLATE_ARGUMENT(const FSlateBrush*, HoverCellBrush)
+
+		/** Size of a cell in grid pixels, used to tell which cell the mouse is over. */
+		SLATE_ATTRIBUTE(float, CellDrawSize)
+
 	SLATE_END_ARGS()
 
 
 	void Construct(const FArguments& InArgs);
 
 
+	/** Shows the hover outline over the cell whose top left corner is at the grid position, tinted by the color. */
+	void SetHoverOutline(const FVector2D& InCellPosition, const FLinearColor& InColor);
+	void ClearHoverOutline();
+
+
 	//~ Begin SWidget Overrides
 	virtual FCursorReply OnCursorQuery(const FGeometry& InMyGeometry, const FPointerEvent& InCursorEvent) const override;
 	virtual TOptional<TSharedRef<SWidget>> OnMapCursor(const FCursorReply& InCursorReply) const override;
@@ -42,12 +61,30 @@ public:
 	virtual void OnMouseEnter(const FGeometry& InMyGeometry, const FPointerEvent& InMouseEvent) override;
 	virtual void OnMouseLeave(const FPointerEvent& InMouseEvent) override;
 	virtual FReply OnMouseMove(const FGeometry& InMyGeometry, const FPointerEvent& InMouseEvent) override;
+	virtual FReply OnMouseWheel(const FGeometry& InMyGeometry, const FPointerEvent& InMouseEvent) override;
+	virtual int32 OnPaint(const FPaintArgs& InArgs, const FGeometry& InAllottedGeometry, const FSlateRect& InMyCullingRect, FSlateWindowElementList& OutDrawElements, int32 InLayerId, const FWidgetStyle& InWidgetStyle, bool bInParentEnabled) const override;
 	//~ End SWidget Overrides
 
 
 private:
 	FMinesweeperGridPositionDelegate OnCellLeftClick;
 	FMinesweeperGridPositionDelegate OnCellRightClick;
+	FMinesweeperGridPositionDelegate OnCellChordClick;
 	FMinesweeperGridHoverPositionDelegate OnHoverCellChanged;
+	FMinesweeperGridScrollDelegate OnGridScroll;
+
+	const FSlateBrush* HoverCellBrush = nullptr;
+	TAttribute<float> CellDrawSize;
+
+	/** Cell under the mouse in grid pixels divided by the cell draw size, mouse moves inside it are ignored. */
+	FIntPoint LastHoverCell = FIntPoint(INDEX_NONE, INDEX_NONE);
+
+	bool bHasHoverOutline = false;
+	FVector2D HoverOutlinePosition = FVector2D::ZeroVector;
+	FLinearColor HoverOutlineColor = FLinearColor::White;
+
+
+	/** Returns the cell under a grid position, in grid pixels divided by the cell draw size. */
+	FIntPoint GridPositionToHoverCell(const FVector2D& InGridPosition) const;
 
 };
@@ -12,6 +12,7 @@
 #include "Widgets/Layout/SWidgetSwitcher.h"
 #include "Widgets/Input/SNumericEntryBox.h"
 #include "Widgets/Input/SEditableTextBox.h"
+#include "Widgets/Input/SCheckBox.h"
 #include "Widgets/Text/SRichTextBlock.h"
 #include "Widgets/Images/SImage.h"
 #include "ISettingsModule.h"
@@ -87,7 +88,7 @@ void SMinesweeperWindow::Construct(const FArguments& InArgs)
 				.Padding(5.0f, 5.0f, 5.0f, 0.0f)
 				[
 					SNew(SBox)
-					.WidthOverride(360).HeightOverride(270)
+					.WidthOverride(360).HeightOverride(370)
 					[
 						SNew(SWidgetSwitcher)
 						.WidgetIndex_Lambda([&]() { return ActiveGameSetupPanel; })
@@ -338,13 +339,13 @@ TSharedRef<SVerticalBox> SMinesweeperWindow::ConstructNewGameSettingsPanel()
 				LOCTEXT("NewGridWidthLabel", "Width:"),
 				SNew(SNumericEntryBox<int32>)
 				.AllowSpin(true)
-				.MinSliderValue(UMinesweeperGame::MinGridSize).MaxSliderValue(UMinesweeperGame::MaxGridSize)
-				.MinValue(UMinesweeperGame::MinGridSize).MaxValue(UMinesweeperGame::MaxGridSize)
+				.MinSliderValue(UMinesweeperGame::MinGridSize).MaxSliderValue_Lambda([&]() { return GetMaxGridSize(); })
+				.MinValue(UMinesweeperGame::MinGridSize).MaxValue_Lambda([&]() { return GetMaxGridSize(); })
 				.Value_Lambda([&] { return Settings->LastDifficulty.Width; })
 				.OnValueChanged_Lambda([&](int32 InNewValue)
 					{
 						Settings->LastDifficulty.Width = InNewValue;
-						MaxMineCount = FMath::FloorToInt32(Settings->LastDifficulty.TotalCells() * 0.25f);
+						UpdateMaxMineCount();
 					})
 			)
 		]
@@ -357,13 +358,13 @@ TSharedRef<SVerticalBox> SMinesweeperWindow::ConstructNewGameSettingsPanel()
 				LOCTEXT("NewGridHeightLabel", "Height:"), 
 				SNew(SNumericEntryBox<int32>)
 				.AllowSpin(true)
-				.MinSliderValue(UMinesweeperGame::MinGridSize).MaxSliderValue(UMinesweeperGame::MaxGridSize)
-				.MinValue(UMinesweeperGame::MinGridSize).MaxValue(UMinesweeperGame::MaxGridSize)
+				.MinSliderValue(UMinesweeperGame::MinGridSize).MaxSliderValue_Lambda([&]() { return GetMaxGridSize(); })
+				.MinValue(UMinesweeperGame::MinGridSize).MaxValue_Lambda([&]() { return GetMaxGridSize(); })
 				.Value_Lambda([&] { return Settings->LastDifficulty.Height; })
 				.OnValueChanged_Lambda([&](int32 InNewValue)
 					{
 						Settings->LastDifficulty.Height = InNewValue;
-						MaxMineCount = FMath::FloorToInt32(Settings->LastDifficulty.TotalCells() * 0.25f);
+						UpdateMaxMineCount();
 					})
 			)
 		]
@@ -383,6 +384,73 @@ TSharedRef<SVerticalBox> SMinesweeperWindow::ConstructNewGameSettingsPanel()
 				.Value_Lambda([&] { return Settings->LastDifficulty.MineCount; })
 				.OnValueChanged_Lambda([&](int32 InNewValue) { Settings->LastDifficulty.MineCount = InNewValue; })
 			)
+		]
+		// NEW GAME FIRST CLICK SAFE ZONE
+		+ SVerticalBox::Slot().AutoHeight()
+		.HAlign(HAlign_Fill).VAlign(VAlign_Center)
+		.Padding(10.0f, 0.0f, 10.0f, 5.0f)
+		[
+			ConstructGameSettingsRow(
+				LOCTEXT("NewGridSafeZoneLabel", "Safe Zone:"),
+				SNew(SNumericEntryBox<int32>)
+				.AllowSpin(true)
+				.ToolTipText(LOCTEXT("NewGridSafeZoneTooltip", "Size of the mine free square around the first clicked cell. 1 only protects the clicked cell, 3 guarantees an opening."))
+				.MinSliderValue(1).MaxSliderValue(9)
+				.MinValue(1).MaxValue(9)
+				.Delta(2)
+				.Value_Lambda([&] { return Settings->LastDifficulty.SafeZoneSize; })
+				.OnValueChanged_Lambda([&](int32 InNewValue) { Settings->LastDifficulty.SafeZoneSize = InNewValue; })
+			)
+		]
+		// NEW GAME NO GUESSING
+		+ SVerticalBox::Slot().AutoHeight()
+		.HAlign(HAlign_Fill).VAlign(VAlign_Center)
+		.Padding(10.0f, 0.0f, 10.0f, 5.0f)
+		[
+			ConstructGameSettingsRow(
+				LOCTEXT("NewGridNoGuessLabel", "No Guessing:"),
+				SNew(SCheckBox)
+				.ToolTipText(LOCTEXT("NewGridNoGuessTooltip", "Only generate boards that can be solved from the first click by logic alone."))
+				.IsChecked_Lambda([&]() { return Settings->LastDifficulty.bNoGuess ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+				.IsEnabled_Lambda([&]() { return !Settings->LastDifficulty.bLargeBoard && !Settings->LastDifficulty.bUnbounded; })
+				.OnCheckStateChanged_Lambda([&](ECheckBoxState NewCheckState) { Settings->LastDifficulty.bNoGuess = NewCheckState == ECheckBoxState::Checked; })
+			)
+		]
+		// NEW GAME LARGE BOARD
+		+ SVerticalBox::Slot().AutoHeight()
+		.HAlign(HAlign_Fill).VAlign(VAlign_Center)
+		.Padding(10.0f, 0.0f, 10.0f, 5.0f)
+		[
+			ConstructGameSettingsRow(
+				LOCTEXT("NewGridLargeBoardLabel", "Large Board:"),
+				SNew(SCheckBox)
+				.ToolTipText(LOCTEXT("NewGridLargeBoardTooltip", "Allow grids up to 10000x10000 cells with any mine density. Scroll the grid with the mouse wheel, hold shift to scroll sideways."))
+				.IsChecked_Lambda([&]() { return Settings->LastDifficulty.bLargeBoard ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+				.OnCheckStateChanged_Lambda([&](ECheckBoxState NewCheckState)
+					{
+						Settings->LastDifficulty.bLargeBoard = NewCheckState == ECheckBoxState::Checked;
+						Settings->LastDifficulty.Width = FMath::Min(Settings->LastDifficulty.Width, GetMaxGridSize());
+						Settings->LastDifficulty.Height = FMath::Min(Settings->LastDifficulty.Height, GetMaxGridSize());
+						UpdateMaxMineCount();
+					})
+			)
+		]
+		// NEW GAME UNBOUNDED
+		+ SVerticalBox::Slot().AutoHeight()
+		.HAlign(HAlign_Fill).VAlign(VAlign_Center)
+		.Padding(10.0f, 0.0f, 10.0f, 5.0f)
+		[
+			ConstructGameSettingsRow(
+				LOCTEXT("NewGridUnboundedLabel", "Unbounded:"),
+				SNew(SCheckBox)
+				.ToolTipText(LOCTEXT("NewGridUnboundedTooltip", "Play on an endless board. Width and height size the view and the mine count sets the mine density. The game only ends on a mine."))
+				.IsChecked_Lambda([&]() { return Settings->LastDifficulty.bUnbounded ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+				.OnCheckStateChanged_Lambda([&](ECheckBoxState NewCheckState)
+					{
+						Settings->LastDifficulty.bUnbounded = NewCheckState == ECheckBoxState::Checked;
+						UpdateMaxMineCount();
+					})
+			)
 		];
 }
 
@@ -529,6 +597,26 @@ FText SMinesweeperWindow::GetTitleText() const
 	return FText::Format(LOCTEXT("TitleTextLabel", "{0}{1}{2}"), FText::FromString(titleTag), minesweeperText, FText::FromString(endTag));
 }
 
+int32 SMinesweeperWindow::GetMaxGridSize() const
+{
+	return Settings->LastDifficulty.bLargeBoard ? UMinesweeperGame::MaxLargeGridSize : UMinesweeperGame::MaxGridSize;
+}
+
+void SMinesweeperWindow::UpdateMaxMineCount()
+{
+	// large boards are for stress sessions, allow any density that still leaves a 3x3 opening around the first click
+	// unbounded boards only use the mine count as a density, which the chunked board clamps
+	if (Settings->LastDifficulty.bUnbounded)
+		MaxMineCount = FMath::FloorToInt32(Settings->LastDifficulty.TotalCells() * FMinesweeperChunkedBoard::MaxMineDensity);
+	else if (Settings->LastDifficulty.bLargeBoard)
+		MaxMineCount = FMath::Max(UMinesweeperGame::MinMineCount, Settings->LastDifficulty.TotalCells() - 9);
+	else
+		MaxMineCount = FMath::FloorToInt32(Settings->LastDifficulty.TotalCells() * 0.25f);
+
+	Settings->LastDifficulty.MineCount = FMath::Min(Settings->LastDifficulty.MineCount, MaxMineCount);
+}
+
+
 FSlateColor SMinesweeperWindow::GetDifficultyButtonColor(const int32 InDifficultyLevel) const
 {
 	const FLinearColor transparentColor = FLinearColor(0.0f, 0.0f, 0.0f, 0.0f);
@@ -547,12 +635,24 @@ FSlateColor SMinesweeperWindow::GetDifficultyButtonColor(const int32 InDifficult
 
 FReply SMinesweeperWindow::OnDifficultyClick(const int32 InDifficultyLevel)
 {
+	// presets only change the grid, keep the chosen generation options
+	const int32 safeZoneSize = Settings->LastDifficulty.SafeZoneSize;
+	const bool bNoGuess = Settings->LastDifficulty.bNoGuess;
+	const bool bLargeBoard = Settings->LastDifficulty.bLargeBoard;
+	const bool bUnbounded = Settings->LastDifficulty.bUnbounded;
+
 	switch (InDifficultyLevel)
 	{
 	case 0: Settings->LastDifficulty = FMinesweeperDifficulty::Beginner(); break;
 	case 1: Settings->LastDifficulty = FMinesweeperDifficulty::Intermediate(); break;
 	case 2: Settings->LastDifficulty = FMinesweeperDifficulty::Expert(); break;
 	}
+
+	Settings->LastDifficulty.SafeZoneSize = safeZoneSize;
+	Settings->LastDifficulty.bNoGuess = bNoGuess;
+	Settings->LastDifficulty.bLargeBoard = bLargeBoard;
+	Settings->LastDifficulty.bUnbounded = bUnbounded;
+
 	return FReply::Handled();
 }
 
@@ -43,6 +43,12 @@ public:
 
 	int32 MaxMineCount = 225;
 
+	/** Returns the largest grid width and height allowed by the chosen board mode. */
+	int32 GetMaxGridSize() const;
+
+	/** Recomputes MaxMineCount from the chosen grid size and board mode. */
+	void UpdateMaxMineCount();
+
 	/** Max score used in high score calculation. */
 	static const int32 MaxScore = 1000000;
 
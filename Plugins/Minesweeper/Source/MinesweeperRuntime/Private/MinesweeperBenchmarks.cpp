@@ -0,0 +1,936 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperRuntimeModule.h"
+#include "MinesweeperGame.h"
+#include "MinesweeperGridCanvas.h"
+#include "MinesweeperBlueprintLib.h"
+#include "MinesweeperBitBoard.h"
+#include "MinesweeperNoGuessGenerator.h"
+#include "MinesweeperOpeningRegions.h"
+#include "MinesweeperSolver.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "UObject/Package.h"
+#include "RenderingThread.h"
+
+
+// Developer console benchmarks for the Minesweeper runtime. Results are written to the output log.
+#if !UE_BUILD_SHIPPING
+
+
+
+
+namespace MinesweeperBenchmarks
+{
+	/** Runs InFunc repeatedly for at least InMinSeconds and returns the average number of seconds per run. */
+	static double TimeIterations(TFunctionRef<void()> InFunc, const double InMinSeconds = 0.25)
+	{
+		int32 numIterations = 0;
+		const double startTime = FPlatformTime::Seconds();
+		double elapsedTime = 0.0;
+		do
+		{
+			InFunc();
+			++numIterations;
+			elapsedTime = FPlatformTime::Seconds() - startTime;
+		} while (elapsedTime < InMinSeconds);
+
+		return elapsedTime / numIterations;
+	}
+
+	static double MegaCellsPerSecond(const int32 InNumCells, const double InSeconds)
+	{
+		return InSeconds > 0.0 ? (InNumCells / InSeconds) / 1000000.0 : 0.0;
+	}
+
+	/** Returns the number of allocator calls made by InFunc. Only counted by allocators that track FMalloc::TotalMallocCalls. */
+	static uint64 CountAllocations(TFunctionRef<void()> InFunc)
+	{
+		const uint64 mallocCallsBefore = (uint64)FMalloc::TotalMallocCalls;
+		InFunc();
+		return (uint64)FMalloc::TotalMallocCalls - mallocCallsBefore;
+	}
+
+
+	static void BenchmarkNeighborMineCounts()
+	{
+		const FIntVector2 gridSizes[] = { FIntVector2(30, 16), FIntVector2(256, 256), FIntVector2(4096, 4096) };
+
+		for (const FIntVector2& gridSize : gridSizes)
+		{
+			const int32 numCells = gridSize.X * gridSize.Y;
+
+			// random mines at roughly expert density
+			TArray<FMinesweeperCell> cells;
+			cells.SetNum(numCells);
+			FMinesweeperBitBoard bitBoard(gridSize.X, gridSize.Y);
+			FRandomStream randStream(numCells);
+			for (int32 cellIndex = 0; cellIndex < numCells; ++cellIndex)
+			{
+				if (randStream.FRand() < 0.2f)
+				{
+					cells[cellIndex].bHasMine = true;
+					bitBoard.SetMine(cellIndex % gridSize.X, cellIndex / gridSize.X);
+				}
+			}
+
+			// per cell neighbor gathering into an allocated array with bounds checks, the way the counts used to be generated
+			const double referenceSeconds = TimeIterations([&]()
+				{
+					for (int32 cellIndex = 0; cellIndex < numCells; ++cellIndex)
+					{
+						const FIntVector2 cellCoord(cellIndex % gridSize.X, cellIndex / gridSize.X);
+
+						TArray<int32> neighborIndices;
+						for (int32 offsetY = -1; offsetY <= 1; ++offsetY)
+						{
+							for (int32 offsetX = -1; offsetX <= 1; ++offsetX)
+							{
+								const FIntVector2 neighborCoord(cellCoord.X + offsetX, cellCoord.Y + offsetY);
+								if ((offsetX == 0 && offsetY == 0) || neighborCoord.X < 0 || neighborCoord.Y < 0 || neighborCoord.X >= gridSize.X || neighborCoord.Y >= gridSize.Y) continue;
+								neighborIndices.Add((neighborCoord.Y * gridSize.X) + neighborCoord.X);
+							}
+						}
+
+						int32 neighborMineCount = 0;
+						for (const int32 neighborIndex : neighborIndices)
+						{
+							if (cells[neighborIndex].bHasMine) ++neighborMineCount;
+						}
+						cells[cellIndex].NeighborMineCount = neighborMineCount;
+					}
+				});
+
+			const double kernelSeconds = TimeIterations([&]()
+				{
+					bitBoard.ComputeNeighborMineCounts(cells);
+				});
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("NeighborMineCounts %dx%d: reference %.2f Mcells/s, %s bitboard %.2f Mcells/s (%.1fx)"),
+				gridSize.X, gridSize.Y,
+				MegaCellsPerSecond(numCells, referenceSeconds),
+				FMinesweeperBitBoard::GetKernelName(),
+				MegaCellsPerSecond(numCells, kernelSeconds),
+				kernelSeconds > 0.0 ? referenceSeconds / kernelSeconds : 0.0);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkNeighborMineCountsCommand(
+		TEXT("Minesweeper.Benchmark.NeighborMineCounts"),
+		TEXT("Measures cells/second of the per cell and bitboard neighbor mine count passes on 30x16, 256x256 and 4096x4096 grids."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkNeighborMineCounts));
+
+
+	static void BenchmarkCellIteration()
+	{
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+		game->SetupGame(FMinesweeperDifficulty::Expert());
+		game->TryOpenCell(0, 0);
+
+		const int32 gridWidth = game->GetDifficulty().Width;
+		const int32 gridHeight = game->GetDifficulty().Height;
+		int32 checksum = 0;
+
+		// one simulated frame visits every cell and its neighbors, once with an allocated neighbor array per cell like the old GetNeighborCells
+		auto referenceFrame = [&]()
+		{
+			for (int32 cellIndex = 0; cellIndex < game->TotalCellCount(); ++cellIndex)
+			{
+				const FIntVector2 cellCoord = game->GridIndexToCoord(cellIndex);
+
+				TArray<int32> neighborIndices;
+				for (int32 offsetY = -1; offsetY <= 1; ++offsetY)
+				{
+					for (int32 offsetX = -1; offsetX <= 1; ++offsetX)
+					{
+						const FIntVector2 neighborCoord(cellCoord.X + offsetX, cellCoord.Y + offsetY);
+						if ((offsetX == 0 && offsetY == 0) || !game->IsValidGridCoord(neighborCoord)) continue;
+						neighborIndices.Add(game->GridCoordToIndex(neighborCoord));
+					}
+				}
+
+				for (const int32 neighborIndex : neighborIndices)
+				{
+					checksum += game->GetCell(neighborIndex)->bHasMine;
+				}
+			}
+		};
+
+		// and once with the templated iteration functions
+		auto iterationFrame = [&]()
+		{
+			game->ForEachCell([&](const FMinesweeperCell& InCell, const int32 InCellIndex, const FIntVector2& InCellCoord)
+				{
+					game->ForEachNeighbor(InCellIndex, [&](const FMinesweeperCell& InNeighborCell, const int32 InNeighborIndex)
+						{
+							checksum += InNeighborCell.bHasMine;
+						});
+				});
+		};
+
+		const uint64 referenceAllocations = CountAllocations(referenceFrame);
+		const uint64 iterationAllocations = CountAllocations(iterationFrame);
+		const double referenceSeconds = TimeIterations(referenceFrame);
+		const double iterationSeconds = TimeIterations(iterationFrame);
+
+		UE_LOG(LogMinesweeperRuntime, Display, TEXT("CellIteration %dx%d: neighbor arrays %llu allocations/frame %.3f ms, templated %llu allocations/frame %.3f ms (checksum %d)"),
+			gridWidth, gridHeight,
+			referenceAllocations, referenceSeconds * 1000.0,
+			iterationAllocations, iterationSeconds * 1000.0,
+			checksum);
+	}
+
+	static FAutoConsoleCommand BenchmarkCellIterationCommand(
+		TEXT("Minesweeper.Benchmark.CellIteration"),
+		TEXT("Measures allocations and time per frame of visiting every cell and its neighbors on an expert grid."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkCellIteration));
+
+
+	static void BenchmarkNoGuessGeneration()
+	{
+		const FMinesweeperDifficulty difficulties[] = { FMinesweeperDifficulty::Beginner(), FMinesweeperDifficulty::Intermediate(), FMinesweeperDifficulty::Expert() };
+		const int32 numBoards = 20;
+
+		for (const FMinesweeperDifficulty& difficulty : difficulties)
+		{
+			// first click in the middle of the grid with its 3x3 neighborhood kept safe
+			const FIntVector2 firstCellCoord(difficulty.Width / 2, difficulty.Height / 2);
+			TArray<int32> safeCellIndices;
+			for (int32 y = firstCellCoord.Y - 1; y <= firstCellCoord.Y + 1; ++y)
+			{
+				for (int32 x = firstCellCoord.X - 1; x <= firstCellCoord.X + 1; ++x)
+				{
+					safeCellIndices.Add((y * difficulty.Width) + x);
+				}
+			}
+
+			int32 numSucceeded = 0;
+			FMinesweeperNoGuessStats totalStats;
+			for (int32 seed = 0; seed < numBoards; ++seed)
+			{
+				TArray<int32> mineCellIndices;
+				FMinesweeperNoGuessStats stats;
+				if (FMinesweeperNoGuessGenerator::Generate(difficulty, (firstCellCoord.Y * difficulty.Width) + firstCellCoord.X, safeCellIndices, seed, 1.0f, mineCellIndices, stats))
+				{
+					++numSucceeded;
+				}
+
+				totalStats.CandidatesTried += stats.CandidatesTried;
+				totalStats.NumWorkers = stats.NumWorkers;
+				totalStats.Seconds += stats.Seconds;
+			}
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("NoGuessGeneration %dx%d/%d: %d/%d boards, %.1f candidates/board, %.2f ms/board, %.1f candidates/s/core on %d workers"),
+				difficulty.Width, difficulty.Height, difficulty.MineCount,
+				numSucceeded, numBoards,
+				(float)totalStats.CandidatesTried / numBoards,
+				totalStats.Seconds * 1000.0f / numBoards,
+				totalStats.CandidatesPerSecondPerCore(), totalStats.NumWorkers);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkNoGuessGenerationCommand(
+		TEXT("Minesweeper.Benchmark.NoGuessGeneration"),
+		TEXT("Generates boards solvable without guessing for each preset difficulty and reports candidates tried per second per core."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkNoGuessGeneration));
+
+
+	static void BenchmarkSolver()
+	{
+		const int32 numGames = 50;
+
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+		FMinesweeperSolver solver;
+		FMinesweeperSolverBoard board;
+		FMinesweeperSolverResult result;
+		TArray<float> probabilities;
+
+		int32 numSolves = 0;
+		int32 numWins = 0;
+		double totalSeconds = 0.0;
+		double maxSeconds = 0.0;
+		double totalProbabilitySeconds = 0.0;
+		double maxProbabilitySeconds = 0.0;
+
+		for (int32 gameIndex = 0; gameIndex < numGames; ++gameIndex)
+		{
+			game->SetupGame(FMinesweeperDifficulty::Expert());
+			const FIntVector2 firstCellCoord = game->GridIndexToCoord((gameIndex * 97) % game->TotalCellCount());
+			game->TryOpenCell(firstCellCoord.X, firstCellCoord.Y);
+
+			// re-solve after every click like a hint system would, guessing the first unproven cell when stuck
+			while (game->IsGameActive())
+			{
+				const double startTime = FPlatformTime::Seconds();
+				board.CopyFromGame(*game);
+				solver.Solve(board, result);
+				const double solveSeconds = FPlatformTime::Seconds() - startTime;
+
+				++numSolves;
+				totalSeconds += solveSeconds;
+				maxSeconds = FMath::Max(maxSeconds, solveSeconds);
+
+				const double probabilityStartTime = FPlatformTime::Seconds();
+				solver.ComputeMineProbabilities(board, probabilities);
+				const double probabilitySeconds = FPlatformTime::Seconds() - probabilityStartTime;
+
+				totalProbabilitySeconds += probabilitySeconds;
+				maxProbabilitySeconds = FMath::Max(maxProbabilitySeconds, probabilitySeconds);
+
+				if (result.SafeCellIndices.Num() > 0)
+				{
+					const FIntVector2 cellCoord = game->GridIndexToCoord(result.SafeCellIndices[0]);
+					game->TryOpenCell(cellCoord.X, cellCoord.Y);
+					continue;
+				}
+
+				for (int32 cellIndex = 0; cellIndex < board.Cells.Num(); ++cellIndex)
+				{
+					if (!board.IsOpened(cellIndex) && !result.MineCellIndices.Contains(cellIndex))
+					{
+						const FIntVector2 cellCoord = game->GridIndexToCoord(cellIndex);
+						game->TryOpenCell(cellCoord.X, cellCoord.Y);
+						break;
+					}
+				}
+			}
+
+			if (game->HasWon()) ++numWins;
+		}
+
+		UE_LOG(LogMinesweeperRuntime, Display, TEXT("Solver expert: %d solves over %d games (%d won), average %.1f us/solve, worst %.1f us/solve"),
+			numSolves, numGames, numWins,
+			numSolves > 0 ? (totalSeconds / numSolves) * 1000000.0 : 0.0,
+			maxSeconds * 1000000.0);
+
+		UE_LOG(LogMinesweeperRuntime, Display, TEXT("Solver expert: mine probabilities average %.1f us, worst %.1f us"),
+			numSolves > 0 ? (totalProbabilitySeconds / numSolves) * 1000000.0 : 0.0,
+			maxProbabilitySeconds * 1000000.0);
+	}
+
+	static FAutoConsoleCommand BenchmarkSolverCommand(
+		TEXT("Minesweeper.Benchmark.Solver"),
+		TEXT("Plays expert games re-solving the visible board and computing mine probabilities after every click and reports the time per solve."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkSolver));
+
+
+	static void BenchmarkLargeBoard()
+	{
+		const FIntVector2 gridSizes[] = { FIntVector2(1000, 1000), FIntVector2(4000, 4000), FIntVector2(10000, 10000) };
+
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+
+		for (const FIntVector2& gridSize : gridSizes)
+		{
+			// expert density with a 3x3 opening around the first click
+			FMinesweeperDifficulty difficulty(gridSize.X, gridSize.Y, (int32)(((int64)gridSize.X * gridSize.Y * 99) / 480));
+			difficulty.SafeZoneSize = 3;
+			difficulty.bLargeBoard = true;
+
+			const double setupStartTime = FPlatformTime::Seconds();
+			game->SetupGame(difficulty);
+			const double setupSeconds = FPlatformTime::Seconds() - setupStartTime;
+
+			const double clickStartTime = FPlatformTime::Seconds();
+			game->TryOpenCell(gridSize.X / 2, gridSize.Y / 2);
+			const double clickSeconds = FPlatformTime::Seconds() - clickStartTime;
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("Large board %dx%d, %d mines: setup %.1f ms (%.1f Mcells/s), first click %.3f ms opening %d cells"),
+				gridSize.X, gridSize.Y, difficulty.MineCount,
+				setupSeconds * 1000.0, MegaCellsPerSecond(game->TotalCellCount(), setupSeconds),
+				clickSeconds * 1000.0, game->GetLastOpenedCellCount());
+		}
+
+		// release the last grid instead of holding on to it until the next garbage collection
+		game->SetupGame(FMinesweeperDifficulty::Beginner());
+	}
+
+	static FAutoConsoleCommand BenchmarkLargeBoardCommand(
+		TEXT("Minesweeper.Benchmark.LargeBoard"),
+		TEXT("Sets up large boards up to 10000x10000 cells and reports the setup time and the latency of the first click."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkLargeBoard));
+
+
+	static void BenchmarkOpeningRegions()
+	{
+		const FIntVector2 gridSize(1000, 1000);
+		const float mineDensities[] = { 0.1f, 0.15f, 0.2f };
+		const int32 paddedWidth = gridSize.X + 2;
+		const int32 paddedHeight = gridSize.Y + 2;
+		const int32 maxSamples = 256;
+
+		for (const float mineDensity : mineDensities)
+		{
+			// padded cell array like UMinesweeperGame keeps, with the sentinel ring opened
+			TArray<FMinesweeperCell> cells;
+			cells.SetNum(paddedWidth * paddedHeight);
+			for (int32 paddedIndex = 0; paddedIndex < cells.Num(); ++paddedIndex)
+			{
+				const int32 x = paddedIndex % paddedWidth;
+				const int32 y = paddedIndex / paddedWidth;
+				cells[paddedIndex].bIsSentinel = x == 0 || y == 0 || x == paddedWidth - 1 || y == paddedHeight - 1;
+				cells[paddedIndex].bIsOpened = cells[paddedIndex].bIsSentinel;
+			}
+
+			FMinesweeperBitBoard bitBoard(gridSize.X, gridSize.Y);
+			FRandomStream randStream(gridSize.X);
+			for (int32 y = 0; y < gridSize.Y; ++y)
+			{
+				for (int32 x = 0; x < gridSize.X; ++x)
+				{
+					if (randStream.FRand() < mineDensity)
+					{
+						cells[((y + 1) * paddedWidth) + x + 1].bHasMine = true;
+						bitBoard.SetMine(x, y);
+					}
+				}
+			}
+			bitBoard.ComputeNeighborMineCounts(cells, paddedWidth + 1, paddedWidth);
+
+			FMinesweeperOpeningRegions openingRegions;
+			const double buildSeconds = TimeIterations([&]() { openingRegions.Build(cells, paddedWidth); });
+
+			// reveal from the first cell of evenly spread openings
+			TArray<int32> startIndices;
+			const int32 regionStep = FMath::Max(openingRegions.Num() / maxSamples, 1);
+			for (int32 region = 0; region < openingRegions.Num() && startIndices.Num() < maxSamples; region += regionStep)
+			{
+				for (const int32 paddedIndex : openingRegions.GetRegionCells(region))
+				{
+					if (openingRegions.GetRegion(paddedIndex) == region)
+					{
+						startIndices.Add(paddedIndex);
+						break;
+					}
+				}
+			}
+
+			const int32 neighborOffsets[8] = { -paddedWidth - 1, -paddedWidth, -paddedWidth + 1, -1, 1, paddedWidth - 1, paddedWidth, paddedWidth + 1 };
+			TArray<int32> floodFillStack;
+			TArray<int32> openedIndices;
+
+			// the cell by cell flood fill of UMinesweeperGame::OpenCell, recording opened cells so they can be closed again
+			auto floodFill = [&](const int32 InStartIndex)
+			{
+				cells[InStartIndex].bIsOpened = true;
+				openedIndices.Add(InStartIndex);
+				floodFillStack.Add(InStartIndex);
+				while (floodFillStack.Num() > 0)
+				{
+					const int32 paddedIndex = floodFillStack.Pop(false);
+					for (const int32 neighborOffset : neighborOffsets)
+					{
+						FMinesweeperCell& neighborCell = cells[paddedIndex + neighborOffset];
+						if (neighborCell.bIsOpened) continue;
+
+						neighborCell.bIsOpened = true;
+						openedIndices.Add(paddedIndex + neighborOffset);
+						if (neighborCell.NeighborMineCount == 0)
+						{
+							floodFillStack.Add(paddedIndex + neighborOffset);
+						}
+					}
+				}
+			};
+
+			double floodFillSeconds = 0.0;
+			double regionSeconds = 0.0;
+			int64 numRevealedCells = 0;
+			for (const int32 startIndex : startIndices)
+			{
+				openedIndices.Reset();
+				const double floodFillStartTime = FPlatformTime::Seconds();
+				floodFill(startIndex);
+				floodFillSeconds += FPlatformTime::Seconds() - floodFillStartTime;
+				numRevealedCells += openedIndices.Num();
+
+				for (const int32 openedIndex : openedIndices)
+				{
+					cells[openedIndex].bIsOpened = false;
+				}
+
+				const int32 region = openingRegions.GetRegion(startIndex);
+				const double regionStartTime = FPlatformTime::Seconds();
+				cells[startIndex].bIsOpened = true;
+				openingRegions.OpenRegion(cells, region);
+				regionSeconds += FPlatformTime::Seconds() - regionStartTime;
+
+				for (const int32 paddedIndex : openingRegions.GetRegionCells(region))
+				{
+					cells[paddedIndex].bIsOpened = false;
+				}
+			}
+
+			const int32 numSamples = FMath::Max(startIndices.Num(), 1);
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("OpeningRegions %dx%d at %.0f%% mines: %d openings built in %.2f ms (%s), reveal of %.1f cells flood fill %.2f us, region %.2f us (%.1fx)"),
+				gridSize.X, gridSize.Y, mineDensity * 100.0f,
+				openingRegions.Num(), buildSeconds * 1000.0, *FText::AsMemory(openingRegions.GetAllocatedSize()).ToString(),
+				(double)numRevealedCells / numSamples,
+				(floodFillSeconds / numSamples) * 1000000.0, (regionSeconds / numSamples) * 1000000.0,
+				regionSeconds > 0.0 ? floodFillSeconds / regionSeconds : 0.0);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkOpeningRegionsCommand(
+		TEXT("Minesweeper.Benchmark.OpeningRegions"),
+		TEXT("Builds the opening regions of 1000x1000 boards and compares revealing an opening through its region list against the cell by cell flood fill."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkOpeningRegions));
+
+
+	static void BenchmarkParallelFloodFill()
+	{
+		const FIntVector2 gridSizes[] = { FIntVector2(1000, 1000), FIntVector2(4000, 4000) };
+		const int32 parallelMinCells[] = { 0, 256, 1024, 4096, 16384 };
+
+		IConsoleVariable* parallelMinCellsVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("Minesweeper.ParallelFloodFillMinCells"));
+		if (!parallelMinCellsVariable) return;
+
+		const int32 previousParallelMinCells = parallelMinCellsVariable->GetInt();
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+
+		for (const FIntVector2& gridSize : gridSizes)
+		{
+			// sparse enough that the first click opens most of the board
+			FMinesweeperDifficulty difficulty(gridSize.X, gridSize.Y, (int32)(((int64)gridSize.X * gridSize.Y) / 100));
+			difficulty.SafeZoneSize = 3;
+			difficulty.bLargeBoard = true;
+
+			double serialSeconds = 0.0;
+			int32 bestParallelMinCells = 0;
+			double bestSeconds = 0.0;
+
+			// 0 is the serial flood fill, every other value switches to parallel levels once that many cells are pending
+			for (const int32 minCells : parallelMinCells)
+			{
+				parallelMinCellsVariable->Set(minCells, ECVF_SetByConsole);
+				game->SetupGame(difficulty);
+
+				const double clickStartTime = FPlatformTime::Seconds();
+				game->TryOpenCell(gridSize.X / 2, gridSize.Y / 2);
+				const double clickSeconds = FPlatformTime::Seconds() - clickStartTime;
+
+				if (minCells == 0)
+				{
+					serialSeconds = clickSeconds;
+				}
+				else if (bestParallelMinCells == 0 || clickSeconds < bestSeconds)
+				{
+					bestParallelMinCells = minCells;
+					bestSeconds = clickSeconds;
+				}
+
+				UE_LOG(LogMinesweeperRuntime, Display, TEXT("ParallelFloodFill %dx%d, threshold %d: first click %.2f ms opening %d cells (%.1f Mcells/s)"),
+					gridSize.X, gridSize.Y, minCells, clickSeconds * 1000.0, game->GetLastOpenedCellCount(), MegaCellsPerSecond(game->GetLastOpenedCellCount(), clickSeconds));
+			}
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("ParallelFloodFill %dx%d: best threshold %d, %.1fx the serial flood fill on %d workers"),
+				gridSize.X, gridSize.Y, bestParallelMinCells, bestSeconds > 0.0 ? serialSeconds / bestSeconds : 0.0, FTaskGraphInterface::Get().GetNumWorkerThreads());
+		}
+
+		parallelMinCellsVariable->Set(previousParallelMinCells, ECVF_SetByConsole);
+
+		// release the last grid instead of holding on to it until the next garbage collection
+		game->SetupGame(FMinesweeperDifficulty::Beginner());
+	}
+
+	static FAutoConsoleCommand BenchmarkParallelFloodFillCommand(
+		TEXT("Minesweeper.Benchmark.ParallelFloodFill"),
+		TEXT("Opens most of sparse 1000x1000 and 4000x4000 boards with the serial flood fill and with several Minesweeper.ParallelFloodFillMinCells thresholds."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkParallelFloodFill));
+
+
+	static void BenchmarkApplyActions()
+	{
+		const FIntVector2 gridSizes[] = { FIntVector2(30, 16), FIntVector2(100, 100) };
+
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+
+		for (const FIntVector2& gridSize : gridSizes)
+		{
+			FMinesweeperDifficulty difficulty(gridSize.X, gridSize.Y, (gridSize.X * gridSize.Y * 99) / 480);
+			difficulty.bLargeBoard = gridSize.X > UMinesweeperGame::MaxGridSize;
+
+			// GridRandomSeed never changes, so every setup and first click produces the same board
+			// a scripted playthrough from the first click that flags every mine and opens every safe cell in scan order, like a replay of a won game
+			const FMinesweeperAction firstClick = FMinesweeperAction::Open(gridSize.X / 2, gridSize.Y / 2);
+
+			game->SetupGame(difficulty);
+			game->TryOpenCellAt(firstClick.CellX, firstClick.CellY);
+
+			TArray<FMinesweeperAction> actions = { firstClick };
+			for (const TMinesweeperCellRange<const FMinesweeperCell>::FElement element : static_cast<const UMinesweeperGame*>(game)->GetCells())
+			{
+				if (element.Cell.bHasMine)
+				{
+					actions.Add(FMinesweeperAction::Flag(element.Coord.X, element.Coord.Y));
+				}
+			}
+
+			for (const TMinesweeperCellRange<const FMinesweeperCell>::FElement element : static_cast<const UMinesweeperGame*>(game)->GetCells())
+			{
+				if (!element.Cell.bHasMine)
+				{
+					actions.Add(FMinesweeperAction::Open(element.Coord.X, element.Coord.Y));
+				}
+			}
+
+			// redraw on every board change like SMinesweeper does
+			UMinesweeperGridCanvas* gridCanvas = UMinesweeperBlueprintLib::CreateMinesweeperGridCanvas(GetTransientPackage(), game, UMinesweeperGridCanvas::DefaultCellDrawSize());
+			int32 numRedraws = 0;
+			const FDelegateHandle boardChangedHandle = game->OnBoardChanged.AddLambda([gridCanvas, &numRedraws]() { gridCanvas->RedrawChangedCells(); ++numRedraws; });
+
+			// pass 0 makes one call per action, pass 1 hands the whole game to ApplyActions
+			TArray<bool> results;
+			double passSeconds[2] = { };
+			int32 passRedraws[2] = { };
+			bool bWon = true;
+
+			for (int32 pass = 0; pass < 2; ++pass)
+			{
+				game->SetupGame(difficulty);
+				numRedraws = 0;
+
+				const double startTime = FPlatformTime::Seconds();
+				if (pass == 1)
+				{
+					game->ApplyActions(actions, results);
+				}
+				else
+				{
+					for (const FMinesweeperAction& action : actions)
+					{
+						if (game->IsGameOver()) break;
+
+						if (action.Type == EMinesweeperActionType::Flag)
+						{
+							game->TryFlagCellAt(action.CellX, action.CellY);
+						}
+						else
+						{
+							game->TryOpenCellAt(action.CellX, action.CellY);
+						}
+					}
+				}
+				passSeconds[pass] = FPlatformTime::Seconds() - startTime;
+				passRedraws[pass] = numRedraws;
+
+				bWon &= game->HasWon();
+			}
+
+			game->OnBoardChanged.Remove(boardChangedHandle);
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("Apply actions %dx%d, %d actions%s: single calls %.2f ms with %d redraws, ApplyActions %.2f ms with %d redraws (%.1fx)"),
+				gridSize.X, gridSize.Y, actions.Num(), bWon ? TEXT("") : TEXT(" (game not won)"),
+				passSeconds[0] * 1000.0, passRedraws[0], passSeconds[1] * 1000.0, passRedraws[1],
+				passSeconds[1] > 0.0 ? passSeconds[0] / passSeconds[1] : 0.0);
+		}
+	}
+
+	static FAutoConsoleCommand BenchmarkApplyActionsCommand(
+		TEXT("Minesweeper.Benchmark.ApplyActions"),
+		TEXT("Replays a won game with a canvas redrawing on every OnBoardChanged, once as single calls and once as one ApplyActions batch."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkApplyActions));
+
+
+	static void BenchmarkFork()
+	{
+		const FIntVector2 gridSizes[] = { FIntVector2(30, 16), FIntVector2(1000, 1000) };
+
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+
+		for (const FIntVector2& gridSize : gridSizes)
+		{
+			FMinesweeperDifficulty difficulty(gridSize.X, gridSize.Y, (gridSize.X * gridSize.Y * 99) / 480);
+			difficulty.bLargeBoard = gridSize.X > UMinesweeperGame::MaxGridSize;
+
+			game->SetupGame(difficulty);
+			game->TryOpenCell(gridSize.X / 2, gridSize.Y / 2);
+
+			// every lookahead step tries a different closed safe cell of the game in progress
+			TArray<FIntVector2> safeCells;
+			for (const TMinesweeperCellRange<const FMinesweeperCell>::FElement element : static_cast<const UMinesweeperGame*>(game)->GetCells())
+			{
+				if (!element.Cell.bIsOpened && !element.Cell.bHasMine)
+				{
+					safeCells.Add(element.Coord);
+				}
+			}
+			if (safeCells.Num() == 0) continue;
+
+			int32 nextSafeCell = 0;
+			SIZE_T forkBytes = 0;
+			const double forkSeconds = TimeIterations([game, &safeCells, &nextSafeCell, &forkBytes]()
+			{
+				UMinesweeperGame* fork = game->ForkGame();
+				const FIntVector2& cellCoord = safeCells[nextSafeCell++ % safeCells.Num()];
+				fork->TryOpenCell(cellCoord.X, cellCoord.Y);
+				forkBytes = fork->GetAllocatedSize();
+			});
+
+			// the same lookahead on one scratch game, rewound to a snapshot before every step
+			FMinesweeperGameSnapshot baseSnapshot;
+			game->SaveSnapshot(baseSnapshot);
+			UMinesweeperGame* scratchGame = game->ForkGame();
+
+			FMinesweeperGameSnapshot branchSnapshot;
+			const double snapshotSeconds = TimeIterations([scratchGame, &baseSnapshot, &branchSnapshot, &safeCells, &nextSafeCell]()
+			{
+				scratchGame->RestoreSnapshot(baseSnapshot);
+				const FIntVector2& cellCoord = safeCells[nextSafeCell++ % safeCells.Num()];
+				scratchGame->TryOpenCell(cellCoord.X, cellCoord.Y);
+
+				branchSnapshot = baseSnapshot;
+				scratchGame->SaveSnapshot(branchSnapshot);
+			});
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("Fork %dx%d: ForkGame and open %.0f per second (%llu bytes per fork), restore, open and save snapshot %.0f per second (%d of %d pages shared, %llu bytes per snapshot)"),
+				gridSize.X, gridSize.Y,
+				forkSeconds > 0.0 ? 1.0 / forkSeconds : 0.0, (uint64)forkBytes,
+				snapshotSeconds > 0.0 ? 1.0 / snapshotSeconds : 0.0, branchSnapshot.NumSharedPages(), branchSnapshot.NumPages(), (uint64)branchSnapshot.GetAllocatedSize());
+
+			// nothing references the forks, collect them before the next grid
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		}
+
+		game->SetupGame(FMinesweeperDifficulty::Beginner());
+	}
+
+	static FAutoConsoleCommand BenchmarkForkCommand(
+		TEXT("Minesweeper.Benchmark.Fork"),
+		TEXT("Measures lookahead on a game in progress, forking it for every step against rewinding one scratch game to a copy-on-write snapshot."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkFork));
+
+
+	static void BenchmarkCanvasRedraw()
+	{
+		const FIntVector2 gridSizes[] = { FIntVector2(30, 16), FIntVector2(1000, 1000) };
+
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+
+		for (const FIntVector2& gridSize : gridSizes)
+		{
+			FMinesweeperDifficulty difficulty(gridSize.X, gridSize.Y, (gridSize.X * gridSize.Y * 99) / 480);
+			difficulty.bLargeBoard = gridSize.X > UMinesweeperGame::MaxGridSize;
+
+			game->SetupGame(difficulty);
+			game->TryOpenCell(gridSize.X / 2, gridSize.Y / 2);
+
+			// a closed cell inside the view window of the canvas
+			FIntVector2 flagCellCoord(-1, -1);
+			for (const TMinesweeperCellRange<const FMinesweeperCell>::FElement element : static_cast<const UMinesweeperGame*>(game)->GetCells())
+			{
+				if (!element.Cell.bIsOpened)
+				{
+					flagCellCoord = element.Coord;
+					break;
+				}
+			}
+			if (flagCellCoord.X < 0) continue;
+
+			UMinesweeperGridCanvas* gridCanvas = UMinesweeperBlueprintLib::CreateMinesweeperGridCanvas(GetTransientPackage(), game, UMinesweeperGridCanvas::DefaultCellDrawSize());
+
+			// pass 0 updates the whole canvas on every flag toggle as before, pass 1 redraws only the changed cells
+			double passSeconds[2] = { };
+			int32 passDrawnCells[2] = { };
+			for (int32 pass = 0; pass < 2; ++pass)
+			{
+				const FDelegateHandle boardChangedHandle = game->OnBoardChanged.AddLambda([gridCanvas, pass]()
+				{
+					if (pass == 0)
+					{
+						gridCanvas->UpdateResource();
+					}
+					else
+					{
+						gridCanvas->RedrawChangedCells();
+					}
+				});
+
+				passSeconds[pass] = TimeIterations([game, &flagCellCoord]() { game->TryFlagCell(flagCellCoord.X, flagCellCoord.Y); });
+				passDrawnCells[pass] = gridCanvas->GetLastDrawnCellCount();
+
+				game->OnBoardChanged.Remove(boardChangedHandle);
+			}
+
+			int32 viewCellCountX, viewCellCountY;
+			gridCanvas->GetViewCellCount(viewCellCountX, viewCellCountY);
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("Canvas redraw %dx%d (%dx%d cell view), flag toggle: UpdateResource %.3f ms drawing %d cells, RedrawChangedCells %.3f ms drawing %d cells (%.1fx)"),
+				gridSize.X, gridSize.Y, viewCellCountX, viewCellCountY,
+				passSeconds[0] * 1000.0, passDrawnCells[0], passSeconds[1] * 1000.0, passDrawnCells[1],
+				passSeconds[1] > 0.0 ? passSeconds[0] / passSeconds[1] : 0.0);
+		}
+
+		game->SetupGame(FMinesweeperDifficulty::Beginner());
+	}
+
+	static FAutoConsoleCommand BenchmarkCanvasRedrawCommand(
+		TEXT("Minesweeper.Benchmark.CanvasRedraw"),
+		TEXT("Toggles a flag on a game in progress, updating the whole grid canvas every time against redrawing only the changed cells."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkCanvasRedraw));
+
+
+	static void BenchmarkHoverSweep()
+	{
+		const FIntVector2 gridSizes[] = { FIntVector2(30, 16), FIntVector2(1000, 1000) };
+
+		// mouse events per cell as the pointer crosses it, a 1000 Hz mouse moved at a moderate speed
+		const int32 eventsPerCell = 8;
+
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+
+		for (const FIntVector2& gridSize : gridSizes)
+		{
+			FMinesweeperDifficulty difficulty(gridSize.X, gridSize.Y, (gridSize.X * gridSize.Y * 99) / 480);
+			difficulty.bLargeBoard = gridSize.X > UMinesweeperGame::MaxGridSize;
+
+			game->SetupGame(difficulty);
+			game->TryOpenCell(gridSize.X / 2, gridSize.Y / 2);
+
+			UMinesweeperGridCanvas* gridCanvas = UMinesweeperBlueprintLib::CreateMinesweeperGridCanvas(GetTransientPackage(), game, UMinesweeperGridCanvas::DefaultCellDrawSize());
+
+			int32 viewCellCountX, viewCellCountY;
+			gridCanvas->GetViewCellCount(viewCellCountX, viewCellCountY);
+
+			// a few rows are enough, redrawing a large view on every event takes seconds per row
+			const int32 numSweptRows = FMath::Min(viewCellCountY, 4);
+
+			// sweeps the pointer along the top rows of the view, pass 0 sets the canvas hover cell and redraws the canvas on every mouse event as the editor grid used to,
+			// pass 1 does what SMinesweeperGrid and SMinesweeper::UpdateHoverOutline now do: tell the hovered cell apart and, when it changes, look up the outline
+			// color from the canvas for the Slate layer. Canvas redraws are counted by the canvas itself for both passes
+			int32 passRedraws[2] = { };
+			int32 passHoverChanges[2] = { };
+			double passSeconds[2] = { };
+			int32 numOutlinesOverOpenedCells = 0;
+			for (int32 pass = 0; pass < 2; ++pass)
+			{
+				const int32 redrawCountBefore = gridCanvas->GetRedrawCount();
+				const double startTime = FPlatformTime::Seconds();
+				FIntVector2 lastHoverCell(INDEX_NONE, INDEX_NONE);
+				for (int32 y = 0; y < numSweptRows; ++y)
+				{
+					for (int32 i = 0; i < viewCellCountX * eventsPerCell; ++i)
+					{
+						const FVector2D gridPosition((i + 0.5f) * (gridCanvas->GetCellDrawSize() / eventsPerCell), (y + 0.5f) * gridCanvas->GetCellDrawSize());
+
+						FIntVector2 hoverCell;
+						gridCanvas->GridPositionToCellCoord(gridPosition, hoverCell.X, hoverCell.Y);
+
+						if (pass == 0)
+						{
+							gridCanvas->SetHoverCellCoord(hoverCell.X, hoverCell.Y);
+							gridCanvas->UpdateResource();
+						}
+						else
+						{
+							if (hoverCell == lastHoverCell) continue;
+
+							// painting the outline is left to Slate and not timed here
+							const FLinearColor outlineColor = gridCanvas->GetHoverCellColor(hoverCell.X, hoverCell.Y);
+							numOutlinesOverOpenedCells += outlineColor.Equals(UMinesweeperGridCanvas::DefaultHoverCellInvalidColor().GetSpecifiedColor()) ? 1 : 0;
+						}
+
+						lastHoverCell = hoverCell;
+						++passHoverChanges[pass];
+					}
+				}
+				passSeconds[pass] = FPlatformTime::Seconds() - startTime;
+				passRedraws[pass] = gridCanvas->GetRedrawCount() - redrawCountBefore;
+
+				gridCanvas->ClearHoverCell();
+			}
+
+			const int32 numMouseEvents = viewCellCountX * numSweptRows * eventsPerCell;
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("Hover sweep %dx%d (%dx%d cell view), %d mouse events: redraw per event %d canvas redraws in %.1f ms (%.0f redraws/s), hover layer %d canvas redraws (%.0f redraws/s) and %d outline moves (%d over opened cells) in %.3f ms"),
+				gridSize.X, gridSize.Y, viewCellCountX, viewCellCountY, numMouseEvents,
+				passRedraws[0], passSeconds[0] * 1000.0, passSeconds[0] > 0.0 ? passRedraws[0] / passSeconds[0] : 0.0,
+				passRedraws[1], passSeconds[1] > 0.0 ? passRedraws[1] / passSeconds[1] : 0.0, passHoverChanges[1], numOutlinesOverOpenedCells, passSeconds[1] * 1000.0);
+		}
+
+		game->SetupGame(FMinesweeperDifficulty::Beginner());
+	}
+
+	static FAutoConsoleCommand BenchmarkHoverSweepCommand(
+		TEXT("Minesweeper.Benchmark.HoverSweep"),
+		TEXT("Sweeps the pointer over the grid canvas view, redrawing the canvas on every mouse event against only tracking the hovered cell for the Slate hover outline."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkHoverSweep));
+
+
+	static void BenchmarkCanvasSprites()
+	{
+		const FIntVector2 gridSizes[] = { FIntVector2(30, 16), FIntVector2(1000, 1000) };
+
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+
+		for (const FIntVector2& gridSize : gridSizes)
+		{
+			FMinesweeperDifficulty difficulty(gridSize.X, gridSize.Y, (gridSize.X * gridSize.Y * 99) / 480);
+			difficulty.bLargeBoard = gridSize.X > UMinesweeperGame::MaxGridSize;
+
+			game->SetupGame(difficulty);
+
+			UMinesweeperGridCanvas* gridCanvas = UMinesweeperBlueprintLib::CreateMinesweeperGridCanvas(GetTransientPackage(), game, UMinesweeperGridCanvas::DefaultCellDrawSize());
+
+			// the render thread is flushed so the time includes drawing the batches, not just queuing them
+			auto timeFullRedraw = [gridCanvas]()
+				{
+					return TimeIterations([gridCanvas]()
+						{
+							gridCanvas->UpdateResource();
+							FlushRenderingCommands();
+						});
+				};
+
+			// pass 0 draws a board of closed cells only, pass 1 a lost game showing every sprite: open cells, digits, flags and mines
+			const double closedSeconds = timeFullRedraw();
+
+			game->TryOpenCell(gridSize.X / 2, gridSize.Y / 2);
+
+			int32 closedCellCount = 0;
+			FIntVector2 mineCellCoord(-1, -1);
+			for (const TMinesweeperCellRange<const FMinesweeperCell>::FElement element : static_cast<const UMinesweeperGame*>(game)->GetCells())
+			{
+				if (element.Cell.bIsOpened) continue;
+
+				if (element.Cell.bHasMine && mineCellCoord.X < 0)
+				{
+					mineCellCoord = element.Coord;
+				}
+				else if (++closedCellCount % 4 == 0)
+				{
+					game->TryFlagCell(element.Coord.X, element.Coord.Y);
+				}
+			}
+			if (mineCellCoord.X < 0) continue;
+
+			game->TryOpenCell(mineCellCoord.X, mineCellCoord.Y);
+
+			// the second pass only means something on a lost board, where mines are drawn
+			if (!ensureMsgf(game->IsGameOver() && !game->HasWon(), TEXT("Canvas sprites benchmark did not lose the %dx%d game"), gridSize.X, gridSize.Y)) continue;
+
+			const double allSpritesSeconds = timeFullRedraw();
+
+			int32 viewCellCountX, viewCellCountY;
+			gridCanvas->GetViewCellCount(viewCellCountX, viewCellCountY);
+
+			UE_LOG(LogMinesweeperRuntime, Display, TEXT("Canvas sprites %dx%d (%dx%d cell view), full redraw: closed cells only %.3f ms, every sprite type %.3f ms (%.2fx)"),
+				gridSize.X, gridSize.Y, viewCellCountX, viewCellCountY,
+				closedSeconds * 1000.0, allSpritesSeconds * 1000.0,
+				closedSeconds > 0.0 ? allSpritesSeconds / closedSeconds : 0.0);
+		}
+
+		game->SetupGame(FMinesweeperDifficulty::Beginner());
+	}
+
+	static FAutoConsoleCommand BenchmarkCanvasSpritesCommand(
+		TEXT("Minesweeper.Benchmark.CanvasSprites"),
+		TEXT("Redraws the whole grid canvas for a board of closed cells against a lost game showing every cell sprite, both drawn from one sprite atlas batch."),
+		FConsoleCommandDelegate::CreateStatic(&BenchmarkCanvasSprites));
+}
+
+
+
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,311 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperBitBoard.h"
+#include "MinesweeperGame.h"
+#include "Async/ParallelFor.h"
+
+// the kernel is selected at compile time, AVX2 is only used when the target is built with AVX2 enabled
+#if PLATFORM_ENABLE_VECTORINTRINSICS && defined(__AVX2__)
+	#include <immintrin.h>
+	#define MINESWEEPER_BITBOARD_AVX2 1
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+	#include <emmintrin.h>
+	#define MINESWEEPER_BITBOARD_SSE2 1
+#endif
+
+
+
+
+namespace MinesweeperBitBoard
+{
+	/** Plain 64-bit words, also used for the tail words the vector kernels can't fill. */
+	struct FScalarLanes
+	{
+		typedef uint64 VectorType;
+		static constexpr int32 NumWords = 1;
+
+		static FORCEINLINE VectorType Load(const uint64* InPtr) { return *InPtr; }
+		static FORCEINLINE void Store(uint64* OutPtr, const VectorType InValue) { *OutPtr = InValue; }
+		static FORCEINLINE VectorType And(const VectorType InA, const VectorType InB) { return InA & InB; }
+		static FORCEINLINE VectorType Or(const VectorType InA, const VectorType InB) { return InA | InB; }
+		static FORCEINLINE VectorType Xor(const VectorType InA, const VectorType InB) { return InA ^ InB; }
+	};
+
+#if MINESWEEPER_BITBOARD_SSE2
+	/** Two words (128 cells) per operation. */
+	struct FSSE2Lanes
+	{
+		typedef __m128i VectorType;
+		static constexpr int32 NumWords = 2;
+
+		static FORCEINLINE VectorType Load(const uint64* InPtr) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(InPtr)); }
+		static FORCEINLINE void Store(uint64* OutPtr, const VectorType InValue) { _mm_storeu_si128(reinterpret_cast<__m128i*>(OutPtr), InValue); }
+		static FORCEINLINE VectorType And(const VectorType InA, const VectorType InB) { return _mm_and_si128(InA, InB); }
+		static FORCEINLINE VectorType Or(const VectorType InA, const VectorType InB) { return _mm_or_si128(InA, InB); }
+		static FORCEINLINE VectorType Xor(const VectorType InA, const VectorType InB) { return _mm_xor_si128(InA, InB); }
+	};
+	typedef FSSE2Lanes FVectorLanes;
+#elif MINESWEEPER_BITBOARD_AVX2
+	/** Four words (256 cells) per operation. */
+	struct FAVX2Lanes
+	{
+		typedef __m256i VectorType;
+		static constexpr int32 NumWords = 4;
+
+		static FORCEINLINE VectorType Load(const uint64* InPtr) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(InPtr)); }
+		static FORCEINLINE void Store(uint64* OutPtr, const VectorType InValue) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(OutPtr), InValue); }
+		static FORCEINLINE VectorType And(const VectorType InA, const VectorType InB) { return _mm256_and_si256(InA, InB); }
+		static FORCEINLINE VectorType Or(const VectorType InA, const VectorType InB) { return _mm256_or_si256(InA, InB); }
+		static FORCEINLINE VectorType Xor(const VectorType InA, const VectorType InB) { return _mm256_xor_si256(InA, InB); }
+	};
+	typedef FAVX2Lanes FVectorLanes;
+#else
+	typedef FScalarLanes FVectorLanes;
+#endif
+
+
+	template<typename LanesType>
+	FORCEINLINE void FullAdd(const typename LanesType::VectorType InA, const typename LanesType::VectorType InB, const typename LanesType::VectorType InC,
+		typename LanesType::VectorType& OutSum, typename LanesType::VectorType& OutCarry)
+	{
+		const typename LanesType::VectorType ab = LanesType::Xor(InA, InB);
+		OutSum = LanesType::Xor(ab, InC);
+		OutCarry = LanesType::Or(LanesType::And(InA, InB), LanesType::And(InC, ab));
+	}
+
+	/**
+	 * Adds the eight one-bit neighbor planes of a row into a bit-sliced 4-bit count (0-8) for LanesType::NumWords words starting at InWord.
+	 */
+	template<typename LanesType>
+	FORCEINLINE void SumNeighborWords(const uint64* const (&InRows)[8], const int32 InWord, uint64* OutBit0, uint64* OutBit1, uint64* OutBit2, uint64* OutBit3)
+	{
+		typedef typename LanesType::VectorType VectorType;
+
+		const VectorType a = LanesType::Load(InRows[0] + InWord);
+		const VectorType b = LanesType::Load(InRows[1] + InWord);
+		const VectorType c = LanesType::Load(InRows[2] + InWord);
+		const VectorType d = LanesType::Load(InRows[3] + InWord);
+		const VectorType e = LanesType::Load(InRows[4] + InWord);
+		const VectorType f = LanesType::Load(InRows[5] + InWord);
+		const VectorType g = LanesType::Load(InRows[6] + InWord);
+		const VectorType h = LanesType::Load(InRows[7] + InWord);
+
+		// reduce the eight inputs to a ones bit and four twos carries
+		VectorType s1, c1, s2, c2, bit0, c4;
+		FullAdd<LanesType>(a, b, c, s1, c1);
+		FullAdd<LanesType>(d, e, f, s2, c2);
+		const VectorType s3 = LanesType::Xor(g, h);
+		const VectorType c3 = LanesType::And(g, h);
+		FullAdd<LanesType>(s1, s2, s3, bit0, c4);
+
+		// reduce the twos carries to a twos bit and two fours carries
+		VectorType t, c5;
+		FullAdd<LanesType>(c1, c2, c3, t, c5);
+		const VectorType bit1 = LanesType::Xor(t, c4);
+		const VectorType c6 = LanesType::And(t, c4);
+
+		// fours and eights
+		const VectorType bit2 = LanesType::Xor(c5, c6);
+		const VectorType bit3 = LanesType::And(c5, c6);
+
+		LanesType::Store(OutBit0 + InWord, bit0);
+		LanesType::Store(OutBit1 + InWord, bit1);
+		LanesType::Store(OutBit2 + InWord, bit2);
+		LanesType::Store(OutBit3 + InWord, bit3);
+	}
+
+
+	/** Maps each byte to a 64-bit value with one byte (0 or 1) per source bit, used to unpack 8 bit-sliced counts at once. */
+	struct FSpreadTable
+	{
+		uint64 Entries[256];
+
+		FSpreadTable()
+		{
+			for (int32 i = 0; i < 256; ++i)
+			{
+				uint64 value = 0;
+				for (int32 bit = 0; bit < 8; ++bit)
+				{
+					if (i & (1 << bit)) value |= 1ull << (bit * 8);
+				}
+				Entries[i] = value;
+			}
+		}
+	};
+	static const FSpreadTable SpreadTable;
+
+
+	/** Rows per task when the count kernel runs in parallel, large enough to hide the cost of the shifted rows recomputed at each band edge. */
+	static const int32 RowsPerBand = 64;
+
+	/** Boards with fewer mine plane words than this are counted on the calling thread. */
+	static const int32 MinParallelWords = 1 << 14;
+
+
+	/** Writes the west and east shifted copies of a mine row, bit X of a shifted row holds the mine bit of cell X-1 or X+1. */
+	FORCEINLINE void ShiftRow(const uint64* InRow, const int32 InNumWords, uint64* OutWestRow, uint64* OutEastRow)
+	{
+		for (int32 w = 0; w < InNumWords; ++w)
+		{
+			OutWestRow[w] = (InRow[w] << 1) | (w > 0 ? InRow[w - 1] >> 63 : 0);
+			OutEastRow[w] = (InRow[w] >> 1) | (w + 1 < InNumWords ? InRow[w + 1] << 63 : 0);
+		}
+	}
+
+	/**
+	 * Counts the rows [InFirstRow, InEndRow). Shifted rows are kept in a three row ring instead of whole shifted planes,
+	 * so the scratch memory only depends on the board width and bands can run on separate threads.
+	 */
+	template<typename WriterType>
+	void ComputeNeighborMineCountRows(const FMinesweeperBitBoard& InBoard, const int32 InFirstRow, const int32 InEndRow, WriterType& InWriter)
+	{
+		const int32 numWords = InBoard.WordsPerRow;
+
+		// 3 west rows, 3 east rows, a zero row and the 4 bit-sliced sum rows
+		TArray<uint64> scratch;
+		scratch.SetNumZeroed(numWords * 11);
+		uint64* westRows = scratch.GetData();
+		uint64* eastRows = westRows + (numWords * 3);
+		const uint64* zeroRow = eastRows + (numWords * 3);
+		uint64* bit0 = eastRows + (numWords * 4);
+		uint64* bit1 = bit0 + numWords;
+		uint64* bit2 = bit1 + numWords;
+		uint64* bit3 = bit2 + numWords;
+
+		auto getMineRow = [&InBoard, numWords](const int32 InY) { return InBoard.MinePlane.GetData() + (InY * numWords); };
+		auto getRingOffset = [numWords](const int32 InY) { return (InY % 3) * numWords; };
+
+		for (int32 y = FMath::Max(InFirstRow - 1, 0); y < FMath::Min(InFirstRow + 1, InBoard.Height); ++y)
+		{
+			ShiftRow(getMineRow(y), numWords, westRows + getRingOffset(y), eastRows + getRingOffset(y));
+		}
+
+		for (int32 y = InFirstRow; y < InEndRow; ++y)
+		{
+			const bool hasUp = y > 0;
+			const bool hasDown = y + 1 < InBoard.Height;
+
+			if (hasDown)
+			{
+				ShiftRow(getMineRow(y + 1), numWords, westRows + getRingOffset(y + 1), eastRows + getRingOffset(y + 1));
+			}
+
+			const uint64* const rows[8] = {
+				hasUp ? westRows + getRingOffset(y - 1) : zeroRow,
+				hasUp ? getMineRow(y - 1) : zeroRow,
+				hasUp ? eastRows + getRingOffset(y - 1) : zeroRow,
+				westRows + getRingOffset(y),
+				eastRows + getRingOffset(y),
+				hasDown ? westRows + getRingOffset(y + 1) : zeroRow,
+				hasDown ? getMineRow(y + 1) : zeroRow,
+				hasDown ? eastRows + getRingOffset(y + 1) : zeroRow };
+
+			int32 w = 0;
+			for (; w + FVectorLanes::NumWords <= numWords; w += FVectorLanes::NumWords)
+			{
+				SumNeighborWords<FVectorLanes>(rows, w, bit0, bit1, bit2, bit3);
+			}
+			for (; w < numWords; ++w)
+			{
+				SumNeighborWords<FScalarLanes>(rows, w, bit0, bit1, bit2, bit3);
+			}
+
+			// unpack the bit-sliced counts 8 cells at a time
+			for (w = 0; w < numWords; ++w)
+			{
+				for (int32 shift = 0; shift < 64; shift += 8)
+				{
+					const int32 x = (w * 64) + shift;
+					if (x >= InBoard.Width) break;
+
+					const uint64 packedCounts =
+						SpreadTable.Entries[(bit0[w] >> shift) & 0xFF] |
+						(SpreadTable.Entries[(bit1[w] >> shift) & 0xFF] << 1) |
+						(SpreadTable.Entries[(bit2[w] >> shift) & 0xFF] << 2) |
+						(SpreadTable.Entries[(bit3[w] >> shift) & 0xFF] << 3);
+
+					const int32 numCells = FMath::Min(8, InBoard.Width - x);
+					for (int32 i = 0; i < numCells; ++i)
+					{
+						InWriter(x + i, y, (uint8)(packedCounts >> (i * 8)));
+					}
+				}
+			}
+		}
+	}
+
+	/** Counts every row, splitting large boards into bands of rows that are counted in parallel. Every band writes its own cells only. */
+	template<typename WriterType>
+	void ComputeNeighborMineCounts(const FMinesweeperBitBoard& InBoard, WriterType&& InWriter)
+	{
+		if (InBoard.Width <= 0 || InBoard.Height <= 0 || InBoard.MinePlane.Num() < InBoard.WordsPerRow * InBoard.Height) return;
+
+		if (InBoard.MinePlane.Num() < MinParallelWords)
+		{
+			ComputeNeighborMineCountRows(InBoard, 0, InBoard.Height, InWriter);
+			return;
+		}
+
+		const int32 numBands = (InBoard.Height + RowsPerBand - 1) / RowsPerBand;
+		ParallelFor(numBands, [&InBoard, &InWriter](const int32 InBandIndex)
+			{
+				const int32 firstRow = InBandIndex * RowsPerBand;
+				ComputeNeighborMineCountRows(InBoard, firstRow, FMath::Min(firstRow + RowsPerBand, InBoard.Height), InWriter);
+			});
+	}
+}
+
+
+
+
+void FMinesweeperBitBoard::Init(const int32 InWidth, const int32 InHeight)
+{
+	Width = FMath::Max(0, InWidth);
+	Height = FMath::Max(0, InHeight);
+	WordsPerRow = (Width + 63) / 64;
+
+	MinePlane.SetNumZeroed(WordsPerRow * Height);
+	Reset();
+}
+
+void FMinesweeperBitBoard::Reset()
+{
+	FMemory::Memzero(MinePlane.GetData(), MinePlane.Num() * sizeof(uint64));
+}
+
+
+void FMinesweeperBitBoard::ComputeNeighborMineCounts(TArrayView<uint8> OutNeighborMineCounts) const
+{
+	if (OutNeighborMineCounts.Num() < Width * Height) return;
+
+	uint8* outCounts = OutNeighborMineCounts.GetData();
+	MinesweeperBitBoard::ComputeNeighborMineCounts(*this, [outCounts, this](const int32 InX, const int32 InY, const uint8 InCount)
+		{
+			outCounts[(InY * Width) + InX] = InCount;
+		});
+}
+
+void FMinesweeperBitBoard::ComputeNeighborMineCounts(TArrayView<FMinesweeperCell> OutCells, const int32 InFirstCellIndex, const int32 InRowStride) const
+{
+	const int32 rowStride = InRowStride > 0 ? InRowStride : Width;
+	if (Height <= 0 || InFirstCellIndex < 0 || OutCells.Num() < InFirstCellIndex + ((Height - 1) * rowStride) + Width) return;
+
+	FMinesweeperCell* outCells = OutCells.GetData() + InFirstCellIndex;
+	MinesweeperBitBoard::ComputeNeighborMineCounts(*this, [outCells, rowStride](const int32 InX, const int32 InY, const uint8 InCount)
+		{
+			outCells[(InY * rowStride) + InX].NeighborMineCount = InCount;
+		});
+}
+
+
+const TCHAR* FMinesweeperBitBoard::GetKernelName()
+{
+#if MINESWEEPER_BITBOARD_AVX2
+	return TEXT("AVX2");
+#elif MINESWEEPER_BITBOARD_SSE2
+	return TEXT("SSE2");
+#else
+	return TEXT("Scalar");
+#endif
+}
@@ -11,9 +11,9 @@ UMinesweeperGridCanvas* UMinesweeperBlueprintLib::CreateMinesweeperGridCanvas(UO
 {
 	if (!InGame) return nullptr;
 
-	const FIntVector2 gridSize = InGame->GetDifficulty().GridSize();
 	const float cellDrawSize = FMath::Clamp(InCellDrawSize, 10.0f, 64.0f);
-	const FVector2D gridCanvasSize(gridSize.X * cellDrawSize, gridSize.Y * cellDrawSize);
+	const FIntVector2 viewCellCount = UMinesweeperGridCanvas::ComputeViewCellCount(InGame->GetDifficulty().GridSize(), cellDrawSize);
+	const FVector2D gridCanvasSize(viewCellCount.X * cellDrawSize, viewCellCount.Y * cellDrawSize);
 
 	UMinesweeperGridCanvas* gridCanvas = CastChecked<UMinesweeperGridCanvas>(
 		UCanvasRenderTarget2D::CreateCanvasRenderTarget2D(
@@ -60,3 +60,28 @@ bool UMinesweeperBlueprintLib::IsExpertDifficulty(const FMinesweeperDifficulty&
 	return InDifficulty.IsExpert();
 }
 
+
+FMinesweeperSolverResult UMinesweeperBlueprintLib::SolveMinesweeperGame(const UMinesweeperGame* InGame, const bool bInTreatFlagsAsMines)
+{
+	FMinesweeperSolverResult result;
+	if (!InGame) return result;
+
+	FMinesweeperSolver solver;
+	solver.bTreatFlagsAsMines = bInTreatFlagsAsMines;
+	solver.Solve(FMinesweeperSolverBoard::FromGame(*InGame), result);
+
+	return result;
+}
+
+TArray<float> UMinesweeperBlueprintLib::GetMineProbabilities(const UMinesweeperGame* InGame, const bool bInTreatFlagsAsMines)
+{
+	TArray<float> probabilities;
+	if (!InGame) return probabilities;
+
+	FMinesweeperSolver solver;
+	solver.bTreatFlagsAsMines = bInTreatFlagsAsMines;
+	solver.ComputeMineProbabilities(FMinesweeperSolverBoard::FromGame(*InGame), probabilities);
+
+	return probabilities;
+}
+
@@ -0,0 +1,548 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperChunkedBoard.h"
+#include "MinesweeperRuntimeModule.h"
+#include "Async/Async.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Resident Chunks"), STAT_MinesweeperResidentChunks, STATGROUP_Minesweeper);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Paged Out Chunks"), STAT_MinesweeperPagedOutChunks, STATGROUP_Minesweeper);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Blocking Page Ins"), STAT_MinesweeperBlockingPageIns, STATGROUP_Minesweeper);
+DECLARE_MEMORY_STAT(TEXT("Resident Chunk Memory"), STAT_MinesweeperResidentChunkMemory, STATGROUP_Minesweeper);
+DECLARE_MEMORY_STAT(TEXT("Resident Chunk Memory Limit"), STAT_MinesweeperResidentChunkMemoryLimit, STATGROUP_Minesweeper);
+DECLARE_MEMORY_STAT(TEXT("Chunk Page File"), STAT_MinesweeperChunkPageFile, STATGROUP_Minesweeper);
+
+
+
+
+/**
+ * Fixed size page slots in a temporary file under Saved/Minesweeper, deleted once the board and every background read are done with it.
+ */
+class FMinesweeperChunkPageFile
+{
+public:
+	FMinesweeperChunkPageFile()
+	{
+		IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		const FString pageFileDir = FPaths::ProjectSavedDir() / TEXT("Minesweeper");
+		platformFile.CreateDirectoryTree(*pageFileDir);
+
+		Filename = pageFileDir / FString::Printf(TEXT("ChunkPages-%s.bin"), *FGuid::NewGuid().ToString());
+		Handle.Reset(platformFile.OpenWrite(*Filename, false, true));
+
+		if (!Handle)
+		{
+			UE_LOG(LogMinesweeperRuntime, Warning, TEXT("Could not open chunk page file %s, chunks will stay resident"), *Filename);
+		}
+	}
+
+	~FMinesweeperChunkPageFile()
+	{
+		Handle.Reset();
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Filename);
+	}
+
+	bool IsValid() const { return Handle.IsValid(); }
+
+	bool WritePage(const int32 InSlot, const uint8* InPage)
+	{
+		FScopeLock lock(&HandleLock);
+		return Handle->Seek((int64)InSlot * FMinesweeperChunkedBoard::PageSize) && Handle->Write(InPage, FMinesweeperChunkedBoard::PageSize);
+	}
+
+	bool ReadPage(const int32 InSlot, uint8* OutPage)
+	{
+		FScopeLock lock(&HandleLock);
+		return Handle->Seek((int64)InSlot * FMinesweeperChunkedBoard::PageSize) && Handle->Read(OutPage, FMinesweeperChunkedBoard::PageSize);
+	}
+
+private:
+	FString Filename;
+	TUniquePtr<IFileHandle> Handle;
+
+	/** Background reads and the game thread share the handle and its file position. */
+	FCriticalSection HandleLock;
+};
+
+
+
+
+namespace MinesweeperChunkedBoard
+{
+	/** Neighbor deltas in the same order as UMinesweeperGame::NeighborOffsets. */
+	static const int32 NeighborSteps[8][2] = { { -1, -1 }, { 0, -1 }, { 1, -1 }, { -1, 0 }, { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+
+	/** SplitMix64 finalizer, spreads every input bit over the whole output. */
+	FORCEINLINE uint64 Mix64(uint64 InValue)
+	{
+		InValue = (InValue ^ (InValue >> 30)) * 0xBF58476D1CE4E5B9ull;
+		InValue = (InValue ^ (InValue >> 27)) * 0x94D049BB133111EBull;
+		return InValue ^ (InValue >> 31);
+	}
+}
+
+
+
+
+FMinesweeperChunkedBoard::FMinesweeperChunkedBoard()
+{
+}
+
+FMinesweeperChunkedBoard::~FMinesweeperChunkedBoard()
+{
+	CancelPageIns();
+}
+
+
+void FMinesweeperChunkedBoard::Init(const int32 InSeed, const float InMineDensity)
+{
+	Seed = InSeed;
+
+	const double mineDensity = FMath::Clamp(InMineDensity, MinMineDensity, MaxMineDensity);
+	MineHashThreshold = (uint64)(mineDensity * 18446744073709551616.0);
+
+	Reset();
+}
+
+void FMinesweeperChunkedBoard::Reset()
+{
+	CancelPageIns();
+
+	Chunks.Empty();
+	CachedChunkCoord = FIntPoint(MAX_int32, MAX_int32);
+	CachedChunk = nullptr;
+	FloodFillStack.Empty();
+
+	// the page file itself is kept and its slots are overwritten by the next game
+	PageSlots.Empty();
+	FreePageSlots.Empty();
+	NumPageSlots = 0;
+	NumBlockingPageIns = 0;
+
+	bHasSafeZone = false;
+	SafeZoneRadius = 0;
+}
+
+void FMinesweeperChunkedBoard::SetMaxResidentChunks(const int32 InMaxResidentChunks)
+{
+	MaxResidentChunks = FMath::Max(InMaxResidentChunks, 0);
+}
+
+
+void FMinesweeperChunkedBoard::SetSafeZone(const int64 InCenterX, const int64 InCenterY, const int32 InRadius)
+{
+	bHasSafeZone = true;
+	SafeZoneCenterX = InCenterX;
+	SafeZoneCenterY = InCenterY;
+	SafeZoneRadius = FMath::Max(InRadius, 0);
+
+	// cells the view already created may have had mines in the zone, their counts and those of the ring around it change
+	const int32 ringRadius = SafeZoneRadius + 1;
+	for (int64 y = InCenterY - ringRadius; y <= InCenterY + ringRadius; ++y)
+	{
+		for (int64 x = InCenterX - ringRadius; x <= InCenterX + ringRadius; ++x)
+		{
+			if (!IsValidCellCoord(x, y)) continue;
+
+			TUniquePtr<FChunk>* chunk = Chunks.Find(CellToChunkCoord(x, y));
+			if (chunk)
+			{
+				RecomputeCell((*chunk)->Cells[CellToLocalIndex(x, y)], x, y);
+			}
+		}
+	}
+}
+
+bool FMinesweeperChunkedBoard::HasMine(const int64 InCellX, const int64 InCellY) const
+{
+	if (!IsValidCellCoord(InCellX, InCellY) || IsInSafeZone(InCellX, InCellY)) return false;
+
+	return HashCell(Seed, CellToChunkCoord(InCellX, InCellY), CellToLocalIndex(InCellX, InCellY)) < MineHashThreshold;
+}
+
+
+bool FMinesweeperChunkedBoard::IsValidCellCoord(const int64 InCellX, const int64 InCellY)
+{
+	return InCellX >= -MaxCellCoord && InCellY >= -MaxCellCoord && InCellX < MaxCellCoord && InCellY < MaxCellCoord;
+}
+
+FMinesweeperCell& FMinesweeperChunkedBoard::GetCell(const int64 InCellX, const int64 InCellY)
+{
+	const FIntPoint chunkCoord = CellToChunkCoord(InCellX, InCellY);
+	if (!CachedChunk || chunkCoord != CachedChunkCoord)
+	{
+		CachedChunk = &FindOrCreateChunk(chunkCoord);
+		CachedChunkCoord = chunkCoord;
+		CachedChunk->LastTouch = ++TouchClock;
+	}
+
+	return CachedChunk->Cells[CellToLocalIndex(InCellX, InCellY)];
+}
+
+FMinesweeperCell* FMinesweeperChunkedBoard::TryGetCell(const int64 InCellX, const int64 InCellY)
+{
+	const FIntPoint chunkCoord = CellToChunkCoord(InCellX, InCellY);
+	if (IsPagedOut(chunkCoord))
+	{
+		const TFuture<TArray<uint8>>* pendingPageIn = PendingPageIns.Find(chunkCoord);
+		if (!pendingPageIn)
+		{
+			StartPageIn(chunkCoord);
+			return nullptr;
+		}
+
+		if (!pendingPageIn->IsReady()) return nullptr;
+	}
+
+	return &GetCell(InCellX, InCellY);
+}
+
+const FMinesweeperCell* FMinesweeperChunkedBoard::FindCell(const int64 InCellX, const int64 InCellY) const
+{
+	const TUniquePtr<FChunk>* chunk = Chunks.Find(CellToChunkCoord(InCellX, InCellY));
+	return chunk ? &(*chunk)->Cells[CellToLocalIndex(InCellX, InCellY)] : nullptr;
+}
+
+
+int32 FMinesweeperChunkedBoard::OpenCell(const int64 InCellX, const int64 InCellY)
+{
+	if (!IsValidCellCoord(InCellX, InCellY)) return 0;
+
+	FMinesweeperCell& startCell = GetCell(InCellX, InCellY);
+	if (startCell.bIsOpened) return 0;
+
+	// cells are marked open as they are pushed so every cell is visited at most once
+	startCell.bIsOpened = true;
+	int32 numOpenedCells = 1;
+
+	FloodFillStack.Reset();
+	if (startCell.NeighborMineCount == 0 && !startCell.bHasMine)
+	{
+		FloodFillStack.Add(FCellCoord{ InCellX, InCellY });
+	}
+
+	while (FloodFillStack.Num() > 0)
+	{
+		const FCellCoord cellCoord = FloodFillStack.Pop(false);
+
+		for (const int32 (&neighborStep)[2] : MinesweeperChunkedBoard::NeighborSteps)
+		{
+			const int64 neighborX = cellCoord.X + neighborStep[0];
+			const int64 neighborY = cellCoord.Y + neighborStep[1];
+			if (!IsValidCellCoord(neighborX, neighborY)) continue;
+
+			FMinesweeperCell& neighborCell = GetCell(neighborX, neighborY);
+			if (neighborCell.bIsOpened) continue;
+
+			neighborCell.bIsOpened = true;
+			++numOpenedCells;
+
+			if (neighborCell.NeighborMineCount == 0)
+			{
+				FloodFillStack.Add(FCellCoord{ neighborX, neighborY });
+			}
+		}
+	}
+
+	return numOpenedCells;
+}
+
+
+void FMinesweeperChunkedBoard::TrimResidentChunks()
+{
+	if (MaxResidentChunks > 0 && Chunks.Num() > MaxResidentChunks)
+	{
+		struct FChunkTouch
+		{
+			uint64 LastTouch;
+			FIntPoint ChunkCoord;
+		};
+
+		TArray<FChunkTouch> chunkTouches;
+		chunkTouches.Reserve(Chunks.Num());
+		for (const auto& chunk : Chunks)
+		{
+			chunkTouches.Add(FChunkTouch{ chunk.Value->LastTouch, chunk.Key });
+		}
+		chunkTouches.Sort([](const FChunkTouch& InA, const FChunkTouch& InB) { return InA.LastTouch < InB.LastTouch; });
+
+		// go an eighth below the limit so a growing flood fill does not trim after every new chunk
+		const int32 targetChunks = MaxResidentChunks - (MaxResidentChunks / 8);
+		for (const FChunkTouch& chunkTouch : chunkTouches)
+		{
+			if (Chunks.Num() <= targetChunks) break;
+
+			PageOutChunk(chunkTouch.ChunkCoord);
+		}
+	}
+
+	const FMinesweeperChunkStats stats = GetStats();
+	SET_DWORD_STAT(STAT_MinesweeperResidentChunks, stats.NumResidentChunks);
+	SET_DWORD_STAT(STAT_MinesweeperPagedOutChunks, stats.NumPagedOutChunks);
+	SET_DWORD_STAT(STAT_MinesweeperBlockingPageIns, stats.NumBlockingPageIns);
+	SET_MEMORY_STAT(STAT_MinesweeperResidentChunkMemory, stats.ResidentBytes);
+	SET_MEMORY_STAT(STAT_MinesweeperResidentChunkMemoryLimit, stats.MaxResidentBytes);
+	SET_MEMORY_STAT(STAT_MinesweeperChunkPageFile, stats.PageFileBytes);
+}
+
+void FMinesweeperChunkedBoard::PrefetchChunks(const int64 InMinCellX, const int64 InMinCellY, const int64 InMaxCellX, const int64 InMaxCellY)
+{
+	InstallFinishedPageIns();
+
+	if (PageSlots.Num() == 0) return;
+
+	const FIntPoint minChunkCoord = CellToChunkCoord(FMath::Max(InMinCellX, -MaxCellCoord), FMath::Max(InMinCellY, -MaxCellCoord));
+	const FIntPoint maxChunkCoord = CellToChunkCoord(FMath::Min(InMaxCellX, MaxCellCoord - 1), FMath::Min(InMaxCellY, MaxCellCoord - 1));
+	for (int32 chunkY = minChunkCoord.Y; chunkY <= maxChunkCoord.Y; ++chunkY)
+	{
+		for (int32 chunkX = minChunkCoord.X; chunkX <= maxChunkCoord.X; ++chunkX)
+		{
+			const FIntPoint chunkCoord(chunkX, chunkY);
+			if (IsPagedOut(chunkCoord))
+			{
+				StartPageIn(chunkCoord);
+			}
+		}
+	}
+}
+
+
+int32 FMinesweeperChunkedBoard::InstallFinishedPageIns()
+{
+	int32 numInstalled = 0;
+	for (auto pendingPageIn = PendingPageIns.CreateIterator(); pendingPageIn; ++pendingPageIn)
+	{
+		if (pendingPageIn.Value().IsReady())
+		{
+			InstallPagedInChunk(pendingPageIn.Key(), pendingPageIn.Value().Get());
+			pendingPageIn.RemoveCurrent();
+			++numInstalled;
+		}
+	}
+
+	return numInstalled;
+}
+
+
+SIZE_T FMinesweeperChunkedBoard::GetAllocatedSize() const
+{
+	return Chunks.GetAllocatedSize() + (Chunks.Num() * sizeof(FChunk)) + FloodFillStack.GetAllocatedSize()
+		+ PageSlots.GetAllocatedSize() + FreePageSlots.GetAllocatedSize() + PendingPageIns.GetAllocatedSize();
+}
+
+FMinesweeperChunkStats FMinesweeperChunkedBoard::GetStats() const
+{
+	FMinesweeperChunkStats stats;
+	stats.NumResidentChunks = Chunks.Num();
+	stats.NumPendingPageIns = PendingPageIns.Num();
+	stats.NumBlockingPageIns = NumBlockingPageIns;
+	stats.ResidentBytes = (int64)GetAllocatedSize();
+	stats.MaxResidentBytes = (int64)MaxResidentChunks * sizeof(FChunk);
+	stats.PageFileBytes = (int64)NumPageSlots * PageSize;
+
+	for (const auto& pageSlot : PageSlots)
+	{
+		stats.NumPagedOutChunks += Chunks.Contains(pageSlot.Key) ? 0 : 1;
+	}
+
+	return stats;
+}
+
+
+FMinesweeperChunkedBoard::FChunk& FMinesweeperChunkedBoard::FindOrCreateChunk(const FIntPoint& InChunkCoord)
+{
+	TUniquePtr<FChunk>* residentChunk = Chunks.Find(InChunkCoord);
+	if (residentChunk) return **residentChunk;
+
+	const int32* pageSlot = PageSlots.Find(InChunkCoord);
+	if (pageSlot)
+	{
+		// game logic only ever waits on the chunk it needs, a background read of it may already be done
+		TArray<uint8> page;
+		TFuture<TArray<uint8>>* pendingPageIn = PendingPageIns.Find(InChunkCoord);
+		if (pendingPageIn)
+		{
+			NumBlockingPageIns += pendingPageIn->IsReady() ? 0 : 1;
+			page = pendingPageIn->Get();
+			PendingPageIns.Remove(InChunkCoord);
+		}
+		else
+		{
+			++NumBlockingPageIns;
+			page.SetNumZeroed(PageSize);
+			if (!PageFile->ReadPage(*pageSlot, page.GetData()))
+			{
+				UE_LOG(LogMinesweeperRuntime, Warning, TEXT("Could not read chunk %d,%d from the page file, its opened and flagged cells are lost"), InChunkCoord.X, InChunkCoord.Y);
+			}
+		}
+
+		return InstallPagedInChunk(InChunkCoord, page);
+	}
+
+	TUniquePtr<FChunk>& chunk = Chunks.Add(InChunkCoord, MakeUnique<FChunk>());
+	GenerateChunk(InChunkCoord, *chunk);
+	return *chunk;
+}
+
+void FMinesweeperChunkedBoard::GenerateChunk(const FIntPoint& InChunkCoord, FChunk& OutChunk) const
+{
+	// mines of the chunk plus a one cell ring from the neighboring chunks, so counts never need to create another chunk
+	const int32 ringSize = ChunkSize + 2;
+	const int64 firstX = ((int64)InChunkCoord.X * ChunkSize) - 1;
+	const int64 firstY = ((int64)InChunkCoord.Y * ChunkSize) - 1;
+
+	bool mines[ringSize * ringSize];
+	for (int32 y = 0; y < ringSize; ++y)
+	{
+		for (int32 x = 0; x < ringSize; ++x)
+		{
+			mines[(y * ringSize) + x] = HasMine(firstX + x, firstY + y);
+		}
+	}
+
+	for (int32 y = 0; y < ChunkSize; ++y)
+	{
+		for (int32 x = 0; x < ChunkSize; ++x)
+		{
+			const int32 ringIndex = ((y + 1) * ringSize) + x + 1;
+
+			uint8 neighborMineCount = 0;
+			for (const int32 (&neighborStep)[2] : MinesweeperChunkedBoard::NeighborSteps)
+			{
+				neighborMineCount += mines[ringIndex + (neighborStep[1] * ringSize) + neighborStep[0]];
+			}
+
+			FMinesweeperCell& cell = OutChunk.Cells[(y << ChunkShift) + x];
+			cell.bHasMine = mines[ringIndex];
+			cell.NeighborMineCount = neighborMineCount;
+		}
+	}
+}
+
+FMinesweeperChunkedBoard::FChunk& FMinesweeperChunkedBoard::InstallPagedInChunk(const FIntPoint& InChunkCoord, const TArray<uint8>& InPage)
+{
+	TUniquePtr<FChunk>& chunk = Chunks.Add(InChunkCoord, MakeUnique<FChunk>());
+	GenerateChunk(InChunkCoord, *chunk);
+	chunk->LastTouch = ++TouchClock;
+
+	const uint8* openedBits = InPage.GetData();
+	const uint8* flaggedBits = openedBits + (CellsPerChunk / 8);
+	for (int32 i = 0; i < CellsPerChunk; ++i)
+	{
+		chunk->Cells[i].bIsOpened = (openedBits[i >> 3] >> (i & 7)) & 1;
+		chunk->Cells[i].bIsFlagged = (flaggedBits[i >> 3] >> (i & 7)) & 1;
+	}
+
+	return *chunk;
+}
+
+
+void FMinesweeperChunkedBoard::StartPageIn(const FIntPoint& InChunkCoord)
+{
+	const int32* pageSlot = PageSlots.Find(InChunkCoord);
+	if (!pageSlot || PendingPageIns.Contains(InChunkCoord)) return;
+
+	TSharedPtr<FMinesweeperChunkPageFile, ESPMode::ThreadSafe> pageFile = PageFile;
+	const int32 pageSlotIndex = *pageSlot;
+	PendingPageIns.Add(InChunkCoord, Async(EAsyncExecution::ThreadPool, [pageFile, pageSlotIndex]()
+		{
+			TArray<uint8> page;
+			page.SetNumZeroed(PageSize);
+			pageFile->ReadPage(pageSlotIndex, page.GetData());
+			return page;
+		}));
+}
+
+void FMinesweeperChunkedBoard::PageOutChunk(const FIntPoint& InChunkCoord)
+{
+	const TUniquePtr<FChunk>* chunk = Chunks.Find(InChunkCoord);
+	if (!chunk) return;
+
+	uint8 page[PageSize] = { };
+	uint8* openedBits = page;
+	uint8* flaggedBits = page + (CellsPerChunk / 8);
+	bool bHasPlayerState = false;
+	for (int32 i = 0; i < CellsPerChunk; ++i)
+	{
+		const FMinesweeperCell& cell = (*chunk)->Cells[i];
+		openedBits[i >> 3] |= cell.bIsOpened << (i & 7);
+		flaggedBits[i >> 3] |= cell.bIsFlagged << (i & 7);
+		bHasPlayerState |= cell.bIsOpened || cell.bIsFlagged;
+	}
+
+	const int32* pageSlot = PageSlots.Find(InChunkCoord);
+	if (!bHasPlayerState)
+	{
+		// nothing the hash cannot bring back, drop the chunk and any page it had
+		if (pageSlot)
+		{
+			FreePageSlots.Add(*pageSlot);
+			PageSlots.Remove(InChunkCoord);
+		}
+	}
+	else
+	{
+		if (!PageFile)
+		{
+			PageFile = MakeShared<FMinesweeperChunkPageFile, ESPMode::ThreadSafe>();
+		}
+
+		// without a working page file the chunk has to stay resident
+		if (!PageFile->IsValid()) return;
+
+		const int32 pageSlotIndex = pageSlot ? *pageSlot : (FreePageSlots.Num() > 0 ? FreePageSlots.Pop(false) : NumPageSlots++);
+		if (!PageFile->WritePage(pageSlotIndex, page)) return;
+
+		PageSlots.Add(InChunkCoord, pageSlotIndex);
+	}
+
+	if (CachedChunk == chunk->Get())
+	{
+		CachedChunk = nullptr;
+		CachedChunkCoord = FIntPoint(MAX_int32, MAX_int32);
+	}
+
+	Chunks.Remove(InChunkCoord);
+}
+
+void FMinesweeperChunkedBoard::CancelPageIns()
+{
+	for (const auto& pendingPageIn : PendingPageIns)
+	{
+		pendingPageIn.Value.Wait();
+	}
+
+	PendingPageIns.Empty();
+}
+
+void FMinesweeperChunkedBoard::RecomputeCell(FMinesweeperCell& OutCell, const int64 InCellX, const int64 InCellY) const
+{
+	uint8 neighborMineCount = 0;
+	for (const int32 (&neighborStep)[2] : MinesweeperChunkedBoard::NeighborSteps)
+	{
+		neighborMineCount += HasMine(InCellX + neighborStep[0], InCellY + neighborStep[1]);
+	}
+
+	OutCell.bHasMine = HasMine(InCellX, InCellY);
+	OutCell.NeighborMineCount = neighborMineCount;
+}
+
+bool FMinesweeperChunkedBoard::IsInSafeZone(const int64 InCellX, const int64 InCellY) const
+{
+	return bHasSafeZone && FMath::Abs(InCellX - SafeZoneCenterX) <= SafeZoneRadius && FMath::Abs(InCellY - SafeZoneCenterY) <= SafeZoneRadius;
+}
+
+
+uint64 FMinesweeperChunkedBoard::HashCell(const int32 InSeed, const FIntPoint& InChunkCoord, const int32 InLocalIndex)
+{
+	using namespace MinesweeperChunkedBoard;
+
+	const uint64 chunkKey = ((uint64)(uint32)InChunkCoord.X << 32) | (uint32)InChunkCoord.Y;
+	const uint64 cellKey = ((uint64)(uint32)InSeed << 32) | (uint32)InLocalIndex;
+	return Mix64(chunkKey ^ Mix64(cellKey));
+}
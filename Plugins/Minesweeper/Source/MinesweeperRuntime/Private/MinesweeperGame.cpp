@@ -1,6 +1,39 @@
 // Copyright 2022 Brad Monahan. All Rights Reserved.
 
 #include "MinesweeperGame.h"
+#include "MinesweeperRuntimeModule.h"
+#include "MinesweeperBitBoard.h"
+#include "MinesweeperMineSampler.h"
+#include "Algo/BinarySearch.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/Package.h"
+
+
+static TAutoConsoleVariable<int32> CVarMinesweeperMaxResidentChunks(
+	TEXT("Minesweeper.MaxResidentChunks"),
+	16384,
+	TEXT("Chunks of an unbounded board kept in memory, about 4 KB each, before the least recently used are paged out to Saved/Minesweeper. 0 keeps every chunk."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMinesweeperParallelFloodFillMinCells(
+	TEXT("Minesweeper.ParallelFloodFillMinCells"),
+	4096,
+	TEXT("Number of pending cells at which a flood fill switches to expanding breadth first levels on worker threads, see Minesweeper.Benchmark.ParallelFloodFill. 0 never switches."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarMinesweeperUndoJournalMaxBytes(
+	TEXT("Minesweeper.UndoJournalMaxBytes"),
+	16 * 1024 * 1024,
+	TEXT("Memory the undo journal of a game may use before its oldest actions are dropped. 0 disables undo."),
+	ECVF_Default);
+
+
+namespace MinesweeperGame
+{
+	/** Source of UMinesweeperGame::BoardId, games are only created and set up on the game thread. */
+	static uint32 LastBoardId = 0;
+}
 
 
 
@@ -9,132 +42,229 @@ void UMinesweeperGame::SetupGame(const FMinesweeperDifficulty& InDifficulty)
 {
 	Difficulty = InDifficulty;
 
-	const int32 totalCellCount = TotalCellCount();
-	
-	CellMap.Empty(totalCellCount);
+	// only large and unbounded boards avoid the eager neighbor mine counts that limit normal grids
+	const int32 maxGridSize = (Difficulty.bLargeBoard || Difficulty.bUnbounded) ? MaxLargeGridSize : MaxGridSize;
+	Difficulty.Width = FMath::Clamp(Difficulty.Width, MinGridSize, maxGridSize);
+	Difficulty.Height = FMath::Clamp(Difficulty.Height, MinGridSize, maxGridSize);
+
+	// the first clicked cell is always mine free, and a game needs a mine to be won
+	Difficulty.MineCount = FMath::Clamp(Difficulty.MineCount, MinMineCount, Difficulty.TotalCells() - 1);
+
+	PaddedWidth = Difficulty.Width + 2;
+	SetupNeighborOffsets();
+
+	// a game in progress ends with the board it was played on
+	IsActive = false;
+	bHasStarted = false;
+	GameTime = 0.0f;
+	PreStartFlagCellIndices.Reset();
+	PreStartUnboundedFlagCoords.Reset();
+
+	// chunks of unbounded boards are paged out, so their cells cannot be journaled
+	UndoJournal.SetMaxBytes(Difficulty.bUnbounded ? 0 : CVarMinesweeperUndoJournalMaxBytes.GetValueOnGameThread());
+	UndoJournal.Reset();
+	NumUndos = 0;
 
-	for (int32 cellIndex = 0; cellIndex < totalCellCount; ++cellIndex)
+	if (Difficulty.bUnbounded)
 	{
-		CellMap.Add(cellIndex, MakeShareable(new FMinesweeperCell));
+		// cells live in chunks that are created as the board is explored
+		Cells.Empty();
+		ChunkedBoard.Init(GridRandomSeed, Difficulty.MineDensity());
+		ChunkedBoard.SetMaxResidentChunks(CVarMinesweeperMaxResidentChunks.GetValueOnGameThread());
+		MarkAllCellsDirty();
+		return;
+	}
+
+	ChunkedBoard.Reset();
+	OpeningRegions.Reset();
+	ResetCells();
+
+	if (Difficulty.bLargeBoard)
+	{
+		PlaceLargeBoardMines();
+	}
+}
+
+void UMinesweeperGame::SetupNeighborOffsets()
+{
+	// neighbor offsets in padded and grid index space
+	// 0 - 1 - 2
+	// 3 - X - 4
+	// 5 - 6 - 7
+	const FIntVector2 neighborSteps[8] = {
+		FIntVector2(-1,-1), FIntVector2(0,-1), FIntVector2(1,-1),
+		FIntVector2(-1, 0),                    FIntVector2(1, 0),
+		FIntVector2(-1, 1), FIntVector2(0, 1), FIntVector2(1, 1) };
+
+	for (int32 i = 0; i < 8; ++i)
+	{
+		NeighborOffsets[i] = (neighborSteps[i].Y * PaddedWidth) + neighborSteps[i].X;
+		IndexNeighborOffsets[i] = (neighborSteps[i].Y * Difficulty.Width) + neighborSteps[i].X;
 	}
 }
 
 void UMinesweeperGame::RestartGame()
 {
 	IsActive = false;
+	bHasStarted = false;
 	GameTime = 0.0f;
+	PreStartFlagCellIndices.Reset();
+	PreStartUnboundedFlagCoords.Reset();
 
-	ForEachCell([](TSharedRef<FMinesweeperCell> InCell, const int32 InCellIndex, const FVector2D InCellCoord)
-		{
-			InCell->Reset();
-		});
+	UndoJournal.Reset();
+	NumUndos = 0;
+
+	if (Difficulty.bUnbounded)
+	{
+		ChunkedBoard.Reset();
+		return;
+	}
+
+	OpeningRegions.Reset();
+	ResetCells();
+
+	if (Difficulty.bLargeBoard)
+	{
+		PlaceLargeBoardMines();
+	}
 }
 
 
 bool UMinesweeperGame::TryOpenCell(const int32 CellX, const int32 CellY)
 {
-	const int32 cellIndex = GridCoordToIndex(FIntVector2(CellX, CellY));
-	if (!CellMap.Contains(cellIndex)) return false;
+	if (Difficulty.bUnbounded) return TryOpenUnboundedCell(CellX, CellY);
+
+	const FIntVector2 cellCoord(CellX, CellY);
+	const int32 cellIndex = GridCoordToIndex(cellCoord);
+	if (!IsValidGridCoord(cellCoord) || !IsValidGridIndex(cellIndex)) return false;
 
-	TSharedRef<FMinesweeperCell> openCell = CellMap[cellIndex];
+	const int32 paddedIndex = CoordToPaddedIndex(cellCoord);
+	const FMinesweeperCell& openCell = Cells[paddedIndex];
 
 
-	if (IsActive && GameTime > 0.0f) // game is active and started
+	if (IsActive && bHasStarted) // game is active and started
 	{
 		++TotalClicks; // clicks always count towards score
 
-		if (openCell->bIsOpened || openCell->bIsFlagged) return false;
+		if (openCell.bIsOpened || openCell.bIsFlagged) return false;
 
-		OpenCell(openCell, cellIndex);
-
-		if (openCell->bHasMine)
-		{
-			// the game has ended in a loser!
-			IsActive = false;
+		const int32 flagsRemainingBefore = FlagsRemaining;
+		const int32 numOpenedCellsBefore = NumOpenedCells;
 
-			LastHighScoreRank = -1;
-
-			OnGameOver.Broadcast(false, GameTime, TotalClicks);
-			OnGameOvered.Broadcast(false, GameTime, TotalClicks);
-		}
-		else if (HasWon()) // check for win condition
-		{
-			// the game has ended in a winner!
-			IsActive = false;
+		BeginJournalEntry();
+		LastOpenedCellCount = OpenCell(paddedIndex);
+		CommitJournalEntry(FMinesweeperUndoJournal::ECellBit::Opened, flagsRemainingBefore, numOpenedCellsBefore, openCell.bHasMine || HasWon());
 
-			OnGameOver.Broadcast(true, GameTime, TotalClicks);
-			OnGameOvered.Broadcast(true, GameTime, TotalClicks);
-		}
+		CheckGameOver(openCell.bHasMine);
 	}
-	else if (!IsActive && GameTime == 0.0f) // game is NOT active and has NOT started
+	else if (!IsActive && !bHasStarted) // game is NOT active and has NOT started
 	{
 		// start of a new game
 		IsActive = true;
+		bHasStarted = true;
 		TotalClicks = 1;
 		FlagsRemaining = Difficulty.MineCount;
+		BoardId = ++MinesweeperGame::LastBoardId;
 		NumClosedCells = Difficulty.TotalCells();
 		NumOpenedCells = 0;
 
-		FRandomStream randStream(GridRandomSeed);
+		// flags placed before the first click are cleared as the counter starts over, every cell is redrawn with whatever the first opening reveals
+		for (const int32 flagCellIndex : PreStartFlagCellIndices)
+		{
+			Cells[flagCellIndex].bIsFlagged = false;
+		}
+		PreStartFlagCellIndices.Reset();
+		MarkAllCellsDirty();
 
 		// calculate placement of mines after user clicks to avoid the user ever clicking a mine on the first click
-		const int32 totalCellCount = NumClosedCells;
-		int32 minesToPlace = FlagsRemaining;
-		while (minesToPlace > 0)
+		TArray<int32> safeCellIndices;
+		GetSafeZoneCellIndices(cellCoord, safeCellIndices);
+
+		if (Difficulty.bLargeBoard)
 		{
-			int32 randCellIndex = randStream.RandRange(0, totalCellCount - 1);
+			// mines were placed by SetupGame, only the safe zone is left to clear
+			FRandomStream moveRandStream((int32)HashCombine(GetTypeHash(GridRandomSeed), GetTypeHash(cellIndex)));
+			MoveMinesOutOfSafeZone(safeCellIndices, moveRandStream);
 
-			TSharedPtr<FMinesweeperCell> cell = GetCell(randCellIndex);
-			if (!cell.IsValid()) break;
+			LastOpenedCellCount = OpenCell(paddedIndex);
 
-			if (cell != openCell && !cell->bHasMine)
-			{
-				cell->bHasMine = true;
-				--minesToPlace;
-			}
+			NotifyBoardChanged();
+			return true;
 		}
 
-		// calculate neighboring mine counts for each cell
-		int32 currentNeighborMineCount = 0;
-		ForEachCell([&](TSharedRef<FMinesweeperCell> InCell, const int32 InCellIndex, const FVector2D InCellCoord)
+		FRandomStream randStream(GridRandomSeed);
+
+		TArray<int32> mineCellIndices;
+		if (Difficulty.bNoGuess)
+		{
+			FMinesweeperNoGuessGenerator::Generate(Difficulty, cellIndex, safeCellIndices, GridRandomSeed, NoGuessTimeBudget, mineCellIndices, LastNoGuessStats);
+
+			UE_LOG(LogMinesweeperRuntime, Log, TEXT("No-guess generation %s after %d candidates in %.3fs (%.1f candidates/s/core on %d workers)"),
+				LastNoGuessStats.bSucceeded ? TEXT("succeeded") : TEXT("fell back to a normal board"),
+				LastNoGuessStats.CandidatesTried, LastNoGuessStats.Seconds, LastNoGuessStats.CandidatesPerSecondPerCore(), LastNoGuessStats.NumWorkers);
+		}
+
+		// normal generation, also the fallback when no solvable board was found within the time budget
+		if (mineCellIndices.Num() == 0)
+		{
+			FMinesweeperMineSampler::SampleMines(randStream, NumClosedCells, safeCellIndices, FlagsRemaining, mineCellIndices);
+		}
+
+		for (const int32 mineCellIndex : mineCellIndices)
+		{
+			Cells[IndexToPaddedIndex(mineCellIndex)].bHasMine = true;
+		}
+
+		// calculate neighboring mine counts for each cell from the mine bitplane, unless OpenCell computes them as cells are opened
+		if (!Difficulty.UsesLazyNeighborCounts())
+		{
+			FMinesweeperBitBoard bitBoard(Difficulty.Width, Difficulty.Height);
+			for (const int32 mineCellIndex : mineCellIndices)
 			{
-				TArray<TSharedRef<FMinesweeperCell>> neighborCells = GetNeighborCells(InCellIndex);
+				bitBoard.SetMine(mineCellIndex % Difficulty.Width, mineCellIndex / Difficulty.Width);
+			}
 
-				currentNeighborMineCount = 0;
-				for (uint32 i = 0; i < (uint32)neighborCells.Num(); ++i)
-				{
-					if (neighborCells[i]->bHasMine) ++currentNeighborMineCount;
-				}
+			bitBoard.ComputeNeighborMineCounts(Cells, CoordToPaddedIndex(FIntVector2(0, 0)), PaddedWidth);
 
-				TSharedPtr<FMinesweeperCell> cell = GetCell(InCellIndex);
-				if (cell.IsValid())
-				{
-					cell->NeighborMineCount = currentNeighborMineCount;
-				}
-			});
+			OpeningRegions.Build(Cells, PaddedWidth);
+		}
+
+		LastOpenedCellCount = OpenCell(paddedIndex);
 
-		OpenCell(openCell, cellIndex);
+		NotifyBoardChanged();
+	}
+	else // game is over
+	{
+		return false;
 	}
 
 	return true;
 }
 
 
-bool UMinesweeperGame::TryFlagCall(const int32 CellX, const int32 CellY)
+bool UMinesweeperGame::TryFlagCell(const int32 CellX, const int32 CellY)
 {
-	const int32 cellIndex = GridCoordToIndex(FIntVector2(CellX, CellY));
-	if (!CellMap.Contains(cellIndex)) return false;
+	if (Difficulty.bUnbounded) return TryFlagUnboundedCell(CellX, CellY);
+
+	const FIntVector2 cellCoord(CellX, CellY);
+	const int32 cellIndex = GridCoordToIndex(cellCoord);
+	if (!IsValidGridCoord(cellCoord) || !IsValidGridIndex(cellIndex)) return false;
 
-	TSharedRef<FMinesweeperCell> clickCell = CellMap[cellIndex];
+	const int32 paddedIndex = CoordToPaddedIndex(cellCoord);
+	FMinesweeperCell& clickCell = Cells[paddedIndex];
 
 	++TotalClicks; // clicks always count towards score
 
-	if (clickCell->bIsOpened) return false;
+	if (clickCell.bIsOpened) return false;
 
+	// flags placed before the first click are not journaled, the first click clears them, only later ones can be undone
+	const int32 flagsRemainingBefore = FlagsRemaining;
+	const bool bIsJournaled = IsActive && bHasStarted;
 
-	clickCell->bIsFlagged = ~clickCell->bIsFlagged;
 
-	if (clickCell->bIsFlagged)
+	clickCell.bIsFlagged = !clickCell.bIsFlagged;
+
+	if (clickCell.bIsFlagged)
 	{
 		if (FlagsRemaining > 0)
 		{
@@ -146,13 +276,600 @@ bool UMinesweeperGame::TryFlagCall(const int32 CellX, const int32 CellY)
 		++FlagsRemaining;
 	}
 
+	if (bIsJournaled)
+	{
+		BeginJournalEntry();
+		ChangedCellIndices.Add(paddedIndex);
+		CommitJournalEntry(FMinesweeperUndoJournal::ECellBit::Flagged, flagsRemainingBefore, NumOpenedCells, false);
+	}
+	else
+	{
+		if (!bHasStarted && clickCell.bIsFlagged)
+		{
+			PreStartFlagCellIndices.Add(paddedIndex);
+		}
+		MarkCellDirty(paddedIndex);
+	}
+
+	NotifyBoardChanged();
+
+	return true;
+}
+
+
+bool UMinesweeperGame::TryChordCell(const int32 CellX, const int32 CellY)
+{
+	if (Difficulty.bUnbounded) return TryChordUnboundedCell(CellX, CellY);
+
+	const FIntVector2 cellCoord(CellX, CellY);
+	const int32 cellIndex = GridCoordToIndex(cellCoord);
+	if (!IsValidGridCoord(cellCoord) || !IsValidGridIndex(cellIndex)) return false;
+
+	// only opened cells can be chorded, so the game must already be running
+	if (!IsActive || !bHasStarted) return false;
+
+	++TotalClicks; // clicks always count towards score
+
+	const int32 paddedIndex = CoordToPaddedIndex(cellCoord);
+	const FMinesweeperCell& chordCell = Cells[paddedIndex];
+	if (!chordCell.bIsOpened || chordCell.bHasMine || chordCell.NeighborMineCount == 0) return false;
+
+	// sentinels are never flagged
+	int32 numFlaggedNeighbors = 0;
+	for (const int32 neighborOffset : NeighborOffsets)
+	{
+		numFlaggedNeighbors += Cells[paddedIndex + neighborOffset].bIsFlagged;
+	}
+
+	if (numFlaggedNeighbors != chordCell.NeighborMineCount) return false;
+
+	const int32 flagsRemainingBefore = FlagsRemaining;
+	const int32 numOpenedCellsBefore = NumOpenedCells;
+
+	// every neighbor is revealed before the single game over check, a flood fill from one neighbor may already have opened the next
+	int32 numOpenedCells = 0;
+	bool bHitMine = false;
+	BeginJournalEntry();
+	for (const int32 neighborOffset : NeighborOffsets)
+	{
+		const int32 neighborIndex = paddedIndex + neighborOffset;
+		const FMinesweeperCell& neighborCell = Cells[neighborIndex];
+		if (neighborCell.bIsOpened || neighborCell.bIsFlagged) continue;
+
+		numOpenedCells += OpenCell(neighborIndex);
+		bHitMine |= neighborCell.bHasMine;
+	}
+	CommitJournalEntry(FMinesweeperUndoJournal::ECellBit::Opened, flagsRemainingBefore, numOpenedCellsBefore, bHitMine || HasWon());
+
+	if (numOpenedCells == 0) return false;
+
+	LastOpenedCellCount = numOpenedCells;
+
+	CheckGameOver(bHitMine);
+
+	return true;
+}
+
+
+bool UMinesweeperGame::TryOpenCellAt(const int64 CellX, const int64 CellY)
+{
+	if (Difficulty.bUnbounded) return TryOpenUnboundedCell(CellX, CellY);
+
+	return IsValidGridCoord(CellX, CellY) && TryOpenCell((int32)CellX, (int32)CellY);
+}
+
+bool UMinesweeperGame::TryFlagCellAt(const int64 CellX, const int64 CellY)
+{
+	if (Difficulty.bUnbounded) return TryFlagUnboundedCell(CellX, CellY);
+
+	return IsValidGridCoord(CellX, CellY) && TryFlagCell((int32)CellX, (int32)CellY);
+}
+
+bool UMinesweeperGame::TryChordCellAt(const int64 CellX, const int64 CellY)
+{
+	if (Difficulty.bUnbounded) return TryChordUnboundedCell(CellX, CellY);
+
+	return IsValidGridCoord(CellX, CellY) && TryChordCell((int32)CellX, (int32)CellY);
+}
+
+
+bool UMinesweeperGame::TryOpenUnboundedCell(const int64 InCellX, const int64 InCellY)
+{
+	if (!FMinesweeperChunkedBoard::IsValidCellCoord(InCellX, InCellY)) return false;
+
+	if (IsActive && bHasStarted) // game is active and started
+	{
+		++TotalClicks; // clicks always count towards score
+
+		// chunks are heap allocated so the cell stays put while the flood fill creates more of them, they are only paged out afterwards
+		const FMinesweeperCell& openCell = ChunkedBoard.GetCell(InCellX, InCellY);
+		if (openCell.bIsOpened || openCell.bIsFlagged) return false;
+
+		LastOpenedCellCount = ChunkedBoard.OpenCell(InCellX, InCellY);
+		NumOpenedCells += LastOpenedCellCount;
+
+		const bool bHitMine = openCell.bHasMine;
+		ChunkedBoard.TrimResidentChunks();
+
+		// hitting a mine is the only way an unbounded game ends
+		CheckGameOver(bHitMine);
+	}
+	else if (!IsActive && !bHasStarted) // game is NOT active and has NOT started
+	{
+		// start of a new game, mines are derived on demand so only the safe zone needs to be known
+		IsActive = true;
+		bHasStarted = true;
+		TotalClicks = 1;
+		FlagsRemaining = 0;
+		NumClosedCells = 0;
+
+		// flags placed before the first click are cleared as the counter starts over
+		for (const TPair<int64, int64>& flagCoord : PreStartUnboundedFlagCoords)
+		{
+			ChunkedBoard.GetCell(flagCoord.Key, flagCoord.Value).bIsFlagged = false;
+		}
+		PreStartUnboundedFlagCoords.Reset();
+
+		ChunkedBoard.SetSafeZone(InCellX, InCellY, Difficulty.SafeZoneRadius());
+
+		LastOpenedCellCount = ChunkedBoard.OpenCell(InCellX, InCellY);
+		NumOpenedCells = LastOpenedCellCount;
+
+		ChunkedBoard.TrimResidentChunks();
+
+		NotifyBoardChanged();
+	}
+	else // game is over
+	{
+		return false;
+	}
+
 	return true;
 }
 
+bool UMinesweeperGame::TryFlagUnboundedCell(const int64 InCellX, const int64 InCellY)
+{
+	if (!FMinesweeperChunkedBoard::IsValidCellCoord(InCellX, InCellY)) return false;
+
+	FMinesweeperCell& clickCell = ChunkedBoard.GetCell(InCellX, InCellY);
+
+	++TotalClicks; // clicks always count towards score
+
+	if (clickCell.bIsOpened) return false;
+
+	// there is no mine total to count down from, so the counter goes negative with every flag placed
+	clickCell.bIsFlagged = !clickCell.bIsFlagged;
+	FlagsRemaining += clickCell.bIsFlagged ? -1 : 1;
+
+	if (!bHasStarted && clickCell.bIsFlagged)
+	{
+		PreStartUnboundedFlagCoords.Emplace(InCellX, InCellY);
+	}
+
+	ChunkedBoard.TrimResidentChunks();
+
+	NotifyBoardChanged();
+
+	return true;
+}
+
+bool UMinesweeperGame::TryChordUnboundedCell(const int64 InCellX, const int64 InCellY)
+{
+	if (!FMinesweeperChunkedBoard::IsValidCellCoord(InCellX, InCellY)) return false;
+
+	// only opened cells can be chorded, so the game must already be running
+	if (!IsActive || !bHasStarted) return false;
+
+	++TotalClicks; // clicks always count towards score
+
+	const FMinesweeperCell& chordCell = ChunkedBoard.GetCell(InCellX, InCellY);
+	if (!chordCell.bIsOpened || chordCell.bHasMine || chordCell.NeighborMineCount == 0) return false;
+
+	// calls InFunc(NeighborX, NeighborY) for each neighbor within the valid cell range
+	auto forEachNeighbor = [InCellX, InCellY](auto&& InFunc)
+	{
+		for (int64 y = InCellY - 1; y <= InCellY + 1; ++y)
+		{
+			for (int64 x = InCellX - 1; x <= InCellX + 1; ++x)
+			{
+				if ((x != InCellX || y != InCellY) && FMinesweeperChunkedBoard::IsValidCellCoord(x, y))
+				{
+					InFunc(x, y);
+				}
+			}
+		}
+	};
+
+	int32 numFlaggedNeighbors = 0;
+	forEachNeighbor([this, &numFlaggedNeighbors](const int64 InX, const int64 InY) { numFlaggedNeighbors += ChunkedBoard.GetCell(InX, InY).bIsFlagged; });
+
+	if (numFlaggedNeighbors != chordCell.NeighborMineCount) return false;
+
+	// chunks are only paged out once every neighbor is revealed
+	int32 numOpenedCells = 0;
+	bool bHitMine = false;
+	forEachNeighbor([this, &numOpenedCells, &bHitMine](const int64 InX, const int64 InY)
+	{
+		const FMinesweeperCell& neighborCell = ChunkedBoard.GetCell(InX, InY);
+		if (neighborCell.bIsOpened || neighborCell.bIsFlagged) return;
+
+		numOpenedCells += ChunkedBoard.OpenCell(InX, InY);
+		bHitMine |= neighborCell.bHasMine;
+	});
+
+	ChunkedBoard.TrimResidentChunks();
+
+	if (numOpenedCells == 0) return false;
+
+	LastOpenedCellCount = numOpenedCells;
+	NumOpenedCells += numOpenedCells;
+
+	CheckGameOver(bHitMine);
+
+	return true;
+}
+
+
+void UMinesweeperGame::CheckGameOver(const bool InHitMine)
+{
+	const bool bHasWon = !InHitMine && HasWon();
+
+	if (InHitMine)
+	{
+		// the game has ended in a loser!
+		IsActive = false;
+
+		LastHighScoreRank = -1;
+	}
+	else if (bHasWon) // check for win condition
+	{
+		// the game has ended in a winner!
+		IsActive = false;
+	}
+
+	if (!IsActive)
+	{
+		// every mine is shown once the game is over
+		MarkAllCellsDirty();
+	}
+
+	NotifyBoardChanged();
+
+	if (!IsActive)
+	{
+		BroadcastGameOver(bHasWon);
+	}
+}
+
+void UMinesweeperGame::BroadcastGameOver(const bool InWon)
+{
+	// a batch ends with the game, ApplyActions broadcasts once it returns
+	if (bIsApplyingActions)
+	{
+		bGameOverInBatch = true;
+		return;
+	}
+
+	OnGameOver.Broadcast(InWon, GameTime, TotalClicks);
+	OnGameOvered.Broadcast(InWon, GameTime, TotalClicks);
+}
+
+void UMinesweeperGame::NotifyBoardChanged()
+{
+	if (bIsApplyingActions)
+	{
+		bBoardChangedInBatch = true;
+		return;
+	}
+
+	// unbounded boards only ever draw a window of their chunks, which is redrawn whole
+	if (Difficulty.bUnbounded)
+	{
+		MarkAllCellsDirty();
+	}
+
+	OnBoardChanged.Broadcast();
+
+	DirtyCellIndices.Reset();
+	bAllCellsDirty = false;
+}
+
+void UMinesweeperGame::MarkCellDirty(const int32 InPaddedIndex)
+{
+	if (bAllCellsDirty) return;
+
+	DirtyCellIndices.Add(PaddedIndexToIndex(InPaddedIndex));
+}
+
+void UMinesweeperGame::MarkCellsDirty(TConstArrayView<int32> InPaddedIndices)
+{
+	if (bAllCellsDirty) return;
+
+	// past a quarter of the board a full redraw is cheaper than walking the list
+	if (DirtyCellIndices.Num() + InPaddedIndices.Num() > Difficulty.TotalCells() / 4)
+	{
+		MarkAllCellsDirty();
+		return;
+	}
+
+	for (const int32 paddedIndex : InPaddedIndices)
+	{
+		DirtyCellIndices.Add(PaddedIndexToIndex(paddedIndex));
+	}
+}
+
+void UMinesweeperGame::MarkAllCellsDirty()
+{
+	DirtyCellIndices.Reset();
+	bAllCellsDirty = true;
+}
+
+
+bool UMinesweeperGame::Undo()
+{
+	ChangedCellIndices.Reset();
+	const FMinesweeperUndoJournal::FEntry* entry = UndoJournal.Undo(Cells, &ChangedCellIndices);
+	if (!entry) return false;
+
+	FlagsRemaining -= entry->FlagsRemainingDelta;
+	NumOpenedCells -= entry->OpenedCellsDelta;
+	NumClosedCells += entry->OpenedCellsDelta;
+	++NumUndos;
+
+	// the game goes on from before the move that ended it, the clock picks up where it stopped
+	if (entry->bEndedGame)
+	{
+		IsActive = true;
+		LastHighScoreRank = -1;
+
+		// the mines shown at the end are hidden again
+		MarkAllCellsDirty();
+	}
+
+	MarkCellsDirty(ChangedCellIndices);
+	NotifyBoardChanged();
+
+	return true;
+}
+
+bool UMinesweeperGame::Redo()
+{
+	ChangedCellIndices.Reset();
+	const FMinesweeperUndoJournal::FEntry* entry = UndoJournal.Redo(Cells, &ChangedCellIndices);
+	if (!entry) return false;
+
+	FlagsRemaining += entry->FlagsRemainingDelta;
+	NumOpenedCells += entry->OpenedCellsDelta;
+	NumClosedCells -= entry->OpenedCellsDelta;
+
+	MarkCellsDirty(ChangedCellIndices);
+
+	if (entry->bEndedGame)
+	{
+		IsActive = false;
+		MarkAllCellsDirty();
+	}
+
+	NotifyBoardChanged();
+
+	if (entry->bEndedGame)
+	{
+		BroadcastGameOver(HasWon());
+	}
+
+	return true;
+}
+
+
+UMinesweeperGame* UMinesweeperGame::ForkGame(UObject* Outer) const
+{
+	if (Difficulty.bUnbounded) return nullptr;
+
+	UMinesweeperGame* fork = NewObject<UMinesweeperGame>(Outer ? Outer : GetTransientPackage());
+
+	fork->GridRandomSeed = GridRandomSeed;
+	fork->Difficulty = Difficulty;
+	fork->NoGuessTimeBudget = NoGuessTimeBudget;
+	fork->PaddedWidth = PaddedWidth;
+	fork->SetupNeighborOffsets();
+
+	fork->Cells = Cells;
+	fork->BoardId = BoardId;
+
+	fork->IsActive = IsActive;
+	fork->bHasStarted = bHasStarted;
+	fork->PreStartFlagCellIndices = PreStartFlagCellIndices;
+	fork->IsPaused = IsPaused;
+	fork->bIsFork = true;
+	fork->GameTime = GameTime;
+	fork->FlagsRemaining = FlagsRemaining;
+	fork->NumClosedCells = NumClosedCells;
+	fork->NumOpenedCells = NumOpenedCells;
+	fork->LastOpenedCellCount = LastOpenedCellCount;
+	fork->TotalClicks = TotalClicks;
+
+	fork->UndoJournal.SetMaxBytes(UndoJournal.GetMaxBytes());
+
+	return fork;
+}
+
+bool UMinesweeperGame::SaveSnapshot(FMinesweeperGameSnapshot& InOutSnapshot) const
+{
+	if (Difficulty.bUnbounded) return false;
+
+	const int32 numPages = FMath::DivideAndRoundUp(Cells.Num(), FMinesweeperGameSnapshot::CellsPerPage);
+	InOutSnapshot.Pages.SetNum(numPages);
+
+	for (int32 page = 0; page < numPages; ++page)
+	{
+		const int32 firstCell = page * FMinesweeperGameSnapshot::CellsPerPage;
+		const int32 numPageCells = FMath::Min(Cells.Num() - firstCell, FMinesweeperGameSnapshot::CellsPerPage);
+
+		// pages are compared by content, so they are shared even with snapshots of other games
+		const TSharedPtr<const FMinesweeperGameSnapshot::FPage, ESPMode::ThreadSafe>& savedPage = InOutSnapshot.Pages[page];
+		if (savedPage.IsValid() && savedPage->Num() == numPageCells && FMemory::Memcmp(savedPage->GetData(), &Cells[firstCell], numPageCells) == 0) continue;
+
+		InOutSnapshot.Pages[page] = MakeShared<const FMinesweeperGameSnapshot::FPage, ESPMode::ThreadSafe>(&Cells[firstCell], numPageCells);
+	}
+
+	InOutSnapshot.NumCells = Cells.Num();
+	InOutSnapshot.Difficulty = Difficulty;
+	InOutSnapshot.BoardId = BoardId;
+
+	InOutSnapshot.IsActive = IsActive;
+	InOutSnapshot.bHasStarted = bHasStarted;
+	InOutSnapshot.PreStartFlagCellIndices = PreStartFlagCellIndices;
+	InOutSnapshot.GameTime = GameTime;
+	InOutSnapshot.FlagsRemaining = FlagsRemaining;
+	InOutSnapshot.NumClosedCells = NumClosedCells;
+	InOutSnapshot.NumOpenedCells = NumOpenedCells;
+	InOutSnapshot.LastOpenedCellCount = LastOpenedCellCount;
+	InOutSnapshot.TotalClicks = TotalClicks;
+
+	return true;
+}
+
+bool UMinesweeperGame::RestoreSnapshot(const FMinesweeperGameSnapshot& InSnapshot)
+{
+	if (!InSnapshot.IsValid()) return false;
+
+	// a resized cell array holds uninitialized memory, so every page is copied without comparing it first
+	const bool bResized = Difficulty.bUnbounded || Difficulty.Width != InSnapshot.Difficulty.Width || Difficulty.Height != InSnapshot.Difficulty.Height;
+	if (bResized)
+	{
+		Difficulty = InSnapshot.Difficulty;
+		PaddedWidth = Difficulty.Width + 2;
+		SetupNeighborOffsets();
+
+		ChunkedBoard.Reset();
+		Cells.SetNumUninitialized(InSnapshot.NumCells);
+		UndoJournal.SetMaxBytes(CVarMinesweeperUndoJournalMaxBytes.GetValueOnGameThread());
+	}
+	else
+	{
+		Difficulty = InSnapshot.Difficulty;
+	}
+
+	for (int32 page = 0; page < InSnapshot.Pages.Num(); ++page)
+	{
+		const FMinesweeperGameSnapshot::FPage& savedPage = *InSnapshot.Pages[page];
+		FMinesweeperCell* pageCells = &Cells[page * FMinesweeperGameSnapshot::CellsPerPage];
+
+		if (bResized || FMemory::Memcmp(pageCells, savedPage.GetData(), savedPage.Num()) != 0)
+		{
+			FMemory::Memcpy(pageCells, savedPage.GetData(), savedPage.Num());
+		}
+	}
+
+	// the regions only describe the mines they were built for
+	if (BoardId != InSnapshot.BoardId)
+	{
+		OpeningRegions.Reset();
+		BoardId = InSnapshot.BoardId;
+	}
+
+	IsActive = InSnapshot.IsActive;
+	bHasStarted = InSnapshot.bHasStarted;
+	PreStartFlagCellIndices = InSnapshot.PreStartFlagCellIndices;
+	PreStartUnboundedFlagCoords.Reset();
+	GameTime = InSnapshot.GameTime;
+	FlagsRemaining = InSnapshot.FlagsRemaining;
+	NumClosedCells = InSnapshot.NumClosedCells;
+	NumOpenedCells = InSnapshot.NumOpenedCells;
+	LastOpenedCellCount = InSnapshot.LastOpenedCellCount;
+	TotalClicks = InSnapshot.TotalClicks;
+
+	// the journal describes how the game got to where it was, not to the snapshot
+	UndoJournal.Reset();
+
+	MarkAllCellsDirty();
+	NotifyBoardChanged();
+
+	return true;
+}
+
+
+SIZE_T UMinesweeperGame::GetAllocatedSize() const
+{
+	return Cells.GetAllocatedSize() + ChunkedBoard.GetAllocatedSize() + OpeningRegions.GetAllocatedSize() + UndoJournal.GetAllocatedSize()
+		+ FloodFillStack.GetAllocatedSize() + ChangedCellIndices.GetAllocatedSize() + PreStartFlagCellIndices.GetAllocatedSize()
+		+ PreStartUnboundedFlagCoords.GetAllocatedSize();
+}
+
+
+void UMinesweeperGame::BeginJournalEntry()
+{
+	bIsCollectingChangedCells = true;
+	ChangedCellIndices.Reset();
+}
+
+void UMinesweeperGame::CommitJournalEntry(const FMinesweeperUndoJournal::ECellBit InChangedBit, const int32 InFlagsRemainingBefore, const int32 InNumOpenedCellsBefore, const bool InEndsGame)
+{
+	if (!bIsCollectingChangedCells) return;
+
+	bIsCollectingChangedCells = false;
+
+	MarkCellsDirty(ChangedCellIndices);
+	if (!UndoJournal.IsEnabled()) return;
+
+	FMinesweeperUndoJournal::FEntry entry;
+	entry.ChangedBit = InChangedBit;
+	entry.FlagsRemainingDelta = FlagsRemaining - InFlagsRemainingBefore;
+	entry.OpenedCellsDelta = NumOpenedCells - InNumOpenedCellsBefore;
+	entry.bEndedGame = InEndsGame;
+
+	UndoJournal.Record(ChangedCellIndices, entry);
+}
+
+
+int32 UMinesweeperGame::ApplyActions(TConstArrayView<FMinesweeperAction> InActions, TArray<bool>& OutResults)
+{
+	OutResults.Reset(InActions.Num());
+
+	bIsApplyingActions = true;
+	bBoardChangedInBatch = false;
+	bGameOverInBatch = false;
+
+	int32 numSucceeded = 0;
+	for (const FMinesweeperAction& action : InActions)
+	{
+		// nothing is left to act on once the game is over
+		const bool bSucceeded = !IsGameOver() && ApplyAction(action);
+		OutResults.Add(bSucceeded);
+		numSucceeded += bSucceeded ? 1 : 0;
+	}
+
+	bIsApplyingActions = false;
+
+	if (bBoardChangedInBatch)
+	{
+		NotifyBoardChanged();
+	}
+
+	if (bGameOverInBatch)
+	{
+		BroadcastGameOver(HasWon());
+	}
+
+	return numSucceeded;
+}
+
+bool UMinesweeperGame::ApplyAction(const FMinesweeperAction& InAction)
+{
+	switch (InAction.Type)
+	{
+		case EMinesweeperActionType::Open: return TryOpenCellAt(InAction.CellX, InAction.CellY);
+		case EMinesweeperActionType::Flag: return TryFlagCellAt(InAction.CellX, InAction.CellY);
+		case EMinesweeperActionType::Chord: return TryChordCellAt(InAction.CellX, InAction.CellY);
+	}
+
+	return false;
+}
+
 
 bool UMinesweeperGame::IsValidGridIndex(const int32 InCellIndex) const
 {
-	return InCellIndex >= 0 && InCellIndex < TotalCellCount();
+	return InCellIndex >= 0 && InCellIndex < TotalCellCount() && Cells.Num() > 0;
 }
 
 bool UMinesweeperGame::IsValidGridCoord(const FIntVector2& InCellCoord) const
@@ -160,6 +877,13 @@ bool UMinesweeperGame::IsValidGridCoord(const FIntVector2& InCellCoord) const
 	return InCellCoord.X >= 0 && InCellCoord.Y >= 0 && InCellCoord.X < Difficulty.Width && InCellCoord.Y < Difficulty.Height;
 }
 
+bool UMinesweeperGame::IsValidGridCoord(const int64 InCellX, const int64 InCellY) const
+{
+	if (Difficulty.bUnbounded) return FMinesweeperChunkedBoard::IsValidCellCoord(InCellX, InCellY);
+
+	return InCellX >= 0 && InCellY >= 0 && InCellX < Difficulty.Width && InCellY < Difficulty.Height;
+}
+
 int32 UMinesweeperGame::GridCoordToIndex(const FIntVector2& InCellCoord) const
 {
 	return (Difficulty.Width * InCellCoord.Y) + InCellCoord.X;
@@ -167,113 +891,385 @@ int32 UMinesweeperGame::GridCoordToIndex(const FIntVector2& InCellCoord) const
 
 FIntVector2 UMinesweeperGame::GridIndexToCoord(const int32 InCellIndex) const
 {
-	return FIntVector2(FMath::FloorToInt32((float)(InCellIndex % Difficulty.Width)), FMath::FloorToInt32((float)InCellIndex / (float)Difficulty.Width));
+	return FIntVector2(InCellIndex % Difficulty.Width, InCellIndex / Difficulty.Width);
 }
 
 
-int32 UMinesweeperGame::FindCellIndex(TSharedPtr<FMinesweeperCell> InCell) const
+int32 UMinesweeperGame::FindCellIndex(const FMinesweeperCell* InCell) const
 {
-	if (!InCell.IsValid()) return -1;
+	if (!InCell) return -1;
 
-	TArray<TSharedRef<FMinesweeperCell>> allCells;
-	CellMap.GenerateValueArray(allCells);
+	// cells are stored contiguously so the padded index is just the pointer offset into the array
+	const int32 paddedIndex = (int32)(InCell - Cells.GetData());
+	if (!Cells.IsValidIndex(paddedIndex) || InCell->bIsSentinel) return -1;
 
-	return allCells.Find(InCell.ToSharedRef());
+	return PaddedIndexToIndex(paddedIndex);
 }
 
 
-TSharedPtr<FMinesweeperCell> UMinesweeperGame::GetCell(const int32 InCellIndex)
+FMinesweeperCell* UMinesweeperGame::GetCell(const int32 InCellIndex)
 {
-	if (!IsValidGridIndex(InCellIndex)) return nullptr;
-	if (CellMap.Contains(InCellIndex))
+	return IsValidGridIndex(InCellIndex) ? &Cells[IndexToPaddedIndex(InCellIndex)] : nullptr;
+}
+
+const FMinesweeperCell* UMinesweeperGame::GetCell(const int32 InCellIndex) const
+{
+	return IsValidGridIndex(InCellIndex) ? &Cells[IndexToPaddedIndex(InCellIndex)] : nullptr;
+}
+
+
+FMinesweeperCell* UMinesweeperGame::GetCellAt(const int64 InCellX, const int64 InCellY)
+{
+	if (!IsValidGridCoord(InCellX, InCellY)) return nullptr;
+
+	if (Difficulty.bUnbounded) return &ChunkedBoard.GetCell(InCellX, InCellY);
+
+	return GetCell(GridCoordToIndex(FIntVector2((int32)InCellX, (int32)InCellY)));
+}
+
+const FMinesweeperCell* UMinesweeperGame::FindCellAt(const int64 InCellX, const int64 InCellY) const
+{
+	if (!IsValidGridCoord(InCellX, InCellY)) return nullptr;
+
+	if (Difficulty.bUnbounded) return ChunkedBoard.FindCell(InCellX, InCellY);
+
+	return GetCell(GridCoordToIndex(FIntVector2((int32)InCellX, (int32)InCellY)));
+}
+
+const FMinesweeperCell* UMinesweeperGame::TryGetCellAt(const int64 InCellX, const int64 InCellY)
+{
+	if (!IsValidGridCoord(InCellX, InCellY)) return nullptr;
+
+	if (Difficulty.bUnbounded) return ChunkedBoard.TryGetCell(InCellX, InCellY);
+
+	return GetCell(GridCoordToIndex(FIntVector2((int32)InCellX, (int32)InCellY)));
+}
+
+void UMinesweeperGame::PrefetchCells(const int64 InMinCellX, const int64 InMinCellY, const int64 InMaxCellX, const int64 InMaxCellY)
+{
+	if (!Difficulty.bUnbounded) return;
+
+	ChunkedBoard.PrefetchChunks(InMinCellX, InMinCellY, InMaxCellX, InMaxCellY);
+}
+
+void UMinesweeperGame::TrimResidentChunks()
+{
+	if (!Difficulty.bUnbounded) return;
+
+	ChunkedBoard.TrimResidentChunks();
+}
+
+
+void UMinesweeperGame::GetSafeZoneCellIndices(const FIntVector2& InCellCoord, TArray<int32>& OutCellIndices) const
+{
+	// shrink the safe zone until the remaining cells can still hold every mine
+	int32 radius = Difficulty.SafeZoneRadius();
+	FIntVector2 zoneMin, zoneMax;
+	do
+	{
+		zoneMin = FIntVector2(FMath::Max(InCellCoord.X - radius, 0), FMath::Max(InCellCoord.Y - radius, 0));
+		zoneMax = FIntVector2(FMath::Min(InCellCoord.X + radius, Difficulty.Width - 1), FMath::Min(InCellCoord.Y + radius, Difficulty.Height - 1));
+	} while (radius-- > 0 && Difficulty.TotalCells() - ((zoneMax.X - zoneMin.X + 1) * (zoneMax.Y - zoneMin.Y + 1)) < Difficulty.MineCount);
+
+	// row by row so the indices come out sorted
+	OutCellIndices.Reset((zoneMax.X - zoneMin.X + 1) * (zoneMax.Y - zoneMin.Y + 1));
+	for (int32 y = zoneMin.Y; y <= zoneMax.Y; ++y)
 	{
-		return CellMap[InCellIndex];
+		for (int32 x = zoneMin.X; x <= zoneMax.X; ++x)
+		{
+			OutCellIndices.Add(GridCoordToIndex(FIntVector2(x, y)));
+		}
 	}
-	return nullptr;
 }
 
-TArray<TSharedRef<FMinesweeperCell>> UMinesweeperGame::GetNeighborCells(const int32 InCellIndex)
-{
-	TArray<TSharedRef<FMinesweeperCell>> outCellWidgets;
 
-	if (!IsValidGridIndex(InCellIndex)) return outCellWidgets;
+void UMinesweeperGame::PlaceLargeBoardMines()
+{
+	// one bit per cell while sampling, a list or map per mine would not stay bounded at 100M cells
+	FRandomStream randStream(GridRandomSeed);
+	FMinesweeperBitBoard bitBoard(Difficulty.Width, Difficulty.Height);
+	FMinesweeperMineSampler::SampleMines(randStream, bitBoard, Difficulty.MineCount);
 
-	const FIntVector2 cellCoord = GridIndexToCoord(InCellIndex);
+	// every row writes its own cells only
+	ParallelFor(Difficulty.Height, [this, &bitBoard](const int32 InY)
+		{
+			for (int32 x = 0; x < Difficulty.Width; ++x)
+			{
+				if (bitBoard.HasMine(x, InY))
+				{
+					Cells[CoordToPaddedIndex(FIntVector2(x, InY))].bHasMine = true;
+				}
+			}
+		});
 
-	// 2d neighboring tile offsets mapped to array indices
-	// 0 - 1 - 2
-	// 3 - 4 - 5
-	// 6 - 7 - 8
+	// neighbor mine counts are left unknown, large boards always compute them as cells are opened
+}
 
-	const TArray<FIntVector2> Offsets = {
-		FIntVector2(-1,-1), FIntVector2(0,-1), FIntVector2(1,-1),
-		FIntVector2(-1, 0), FIntVector2(0, 0), FIntVector2(1, 0),
-		FIntVector2(-1, 1), FIntVector2(0, 1), FIntVector2(1, 1) };
+void UMinesweeperGame::MoveMinesOutOfSafeZone(TConstArrayView<int32> InSafeCellIndices, FRandomStream& InRandStream)
+{
+	const int32 totalCells = Difficulty.TotalCells();
 
-	for (int32 i = 0; i < 9; ++i)
+	auto isValidTarget = [this, InSafeCellIndices](const int32 InCellIndex)
 	{
-		if (i == 4) continue; // skip middle cell (self)
+		return !Cells[IndexToPaddedIndex(InCellIndex)].bHasMine && Algo::BinarySearch(InSafeCellIndices, InCellIndex) == INDEX_NONE;
+	};
 
-		const FIntVector2 neighborCoord(cellCoord.X + Offsets[i].X, cellCoord.Y + Offsets[i].Y); // FIntVector2 no + operator support
-		if (!IsValidGridCoord(neighborCoord)) continue;
+	for (const int32 safeCellIndex : InSafeCellIndices)
+	{
+		const int32 safePaddedIndex = IndexToPaddedIndex(safeCellIndex);
+		if (!Cells[safePaddedIndex].bHasMine) continue;
 
-		// all cells that are outside of the grid bounds will return null here and not be added
-		TSharedPtr<FMinesweeperCell> cell = GetCell(GridCoordToIndex(neighborCoord));
-		if (cell.IsValid())
+		// a few random draws find a free cell on any playable density, scanning on from the last draw guarantees one on a nearly full board
+		int32 targetIndex = FMinesweeperMineSampler::RandIndex(InRandStream, totalCells);
+		for (int32 attempt = 0; attempt < 64 && !isValidTarget(targetIndex); ++attempt)
 		{
-			outCellWidgets.Add(cell.ToSharedRef());
+			targetIndex = FMinesweeperMineSampler::RandIndex(InRandStream, totalCells);
 		}
-	}
+		for (int32 i = 0; i < totalCells && !isValidTarget(targetIndex); ++i)
+		{
+			targetIndex = (targetIndex + 1) % totalCells;
+		}
+		if (!isValidTarget(targetIndex)) return;
 
-	return outCellWidgets;
+		const int32 targetPaddedIndex = IndexToPaddedIndex(targetIndex);
+
+		// no neighbor mine count is known yet, so nothing else needs patching
+		Cells[safePaddedIndex].bHasMine = false;
+		Cells[targetPaddedIndex].bHasMine = true;
+	}
 }
 
-void UMinesweeperGame::OpenCell(TSharedPtr<FMinesweeperCell> InCell, const int32 InCellIndex)
+
+void UMinesweeperGame::ResetCells()
 {
-	if (!CellMap.Contains(InCellIndex) || CellMap[InCellIndex] != InCell) return;
+	const int32 paddedHeight = Difficulty.Height + 2;
+
+	FMinesweeperCell closedCell;
+	if (Difficulty.UsesLazyNeighborCounts())
+	{
+		closedCell.NeighborMineCount = FMinesweeperCell::UnknownNeighborMineCount;
+	}
+
+	Cells.Init(closedCell, PaddedWidth * paddedHeight);
+	BoardId = ++MinesweeperGame::LastBoardId;
+	MarkAllCellsDirty();
+
+	FMinesweeperCell sentinelCell;
+	sentinelCell.bIsOpened = true;
+	sentinelCell.bIsSentinel = true;
+
+	for (int32 x = 0; x < PaddedWidth; ++x)
+	{
+		Cells[x] = sentinelCell;
+		Cells[((paddedHeight - 1) * PaddedWidth) + x] = sentinelCell;
+	}
+	for (int32 y = 1; y < paddedHeight - 1; ++y)
+	{
+		Cells[y * PaddedWidth] = sentinelCell;
+		Cells[(y * PaddedWidth) + PaddedWidth - 1] = sentinelCell;
+	}
+}
 
-	InCell->bIsOpened = true;
 
-	--NumClosedCells;
-	++NumOpenedCells;
+FORCEINLINE void UMinesweeperGame::ResolveNeighborMineCount(const int32 InPaddedIndex)
+{
+	FMinesweeperCell& cell = Cells[InPaddedIndex];
+	if (cell.HasKnownNeighborMineCount()) return;
 
-	if (InCell->NeighborMineCount == 0)
+	// sentinels never hold a mine
+	uint8 neighborMineCount = 0;
+	for (const int32 neighborOffset : NeighborOffsets)
 	{
-		OpenNeighbors(InCell, InCellIndex);
+		neighborMineCount += Cells[InPaddedIndex + neighborOffset].bHasMine;
 	}
+
+	cell.NeighborMineCount = neighborMineCount;
 }
 
-void UMinesweeperGame::OpenNeighbors(TSharedPtr<FMinesweeperCell> InCell, const int32 InCellIndex)
+int32 UMinesweeperGame::OpenCell(const int32 InPaddedIndex)
 {
-	if (!CellMap.Contains(InCellIndex) || CellMap[InCellIndex] != InCell) return;
+	FMinesweeperCell& startCell = Cells[InPaddedIndex];
+	if (startCell.bIsOpened) return 0;
+
+	// cells are marked open as they are pushed so every cell is visited at most once
+	startCell.bIsOpened = true;
+	ResolveNeighborMineCount(InPaddedIndex);
+	int32 numOpenedCells = 1;
+
+	if (bIsCollectingChangedCells)
+	{
+		ChangedCellIndices.Add(InPaddedIndex);
+	}
+
+	FloodFillStack.Reset();
+	if (startCell.NeighborMineCount == 0 && !startCell.bHasMine)
+	{
+		// an opened cell without neighboring mines always has its whole region opened, so the region list matches the flood fill
+		if (OpeningRegions.IsBuilt())
+		{
+			numOpenedCells += OpeningRegions.OpenRegion(Cells, OpeningRegions.GetRegion(InPaddedIndex), bIsCollectingChangedCells ? &ChangedCellIndices : nullptr);
+		}
+		else
+		{
+			FloodFillStack.Add(InPaddedIndex);
+		}
+	}
+
+	// openings large enough to keep a wide frontier are finished on worker threads, small boards never get there
+	const int32 parallelMinCells = CVarMinesweeperParallelFloodFillMinCells.GetValueOnGameThread();
 
-	TArray<TSharedRef<FMinesweeperCell>> neighborCells = GetNeighborCells(InCellIndex);
-	for (auto cell : neighborCells)
+	while (FloodFillStack.Num() > 0)
 	{
-		const int32 cellIndex = FindCellIndex(cell);
-		if (cellIndex > -1 && !cell->bIsOpened)
+		if (parallelMinCells > 0 && FloodFillStack.Num() >= parallelMinCells)
 		{
-			OpenCell(cell, cellIndex);
+			numOpenedCells += ParallelFloodFill();
+			break;
+		}
+
+		const int32 paddedIndex = FloodFillStack.Pop(false);
+
+		// the sentinel ring is always opened so no bounds checks are needed here
+		for (const int32 neighborOffset : NeighborOffsets)
+		{
+			const int32 neighborIndex = paddedIndex + neighborOffset;
+			FMinesweeperCell& neighborCell = Cells[neighborIndex];
+			if (neighborCell.bIsOpened) continue;
+
+			neighborCell.bIsOpened = true;
+			ResolveNeighborMineCount(neighborIndex);
+			++numOpenedCells;
+
+			if (bIsCollectingChangedCells)
+			{
+				ChangedCellIndices.Add(neighborIndex);
+			}
+
+			if (neighborCell.NeighborMineCount == 0)
+			{
+				FloodFillStack.Add(neighborIndex);
+			}
 		}
 	}
+
+	NumClosedCells -= numOpenedCells;
+	NumOpenedCells += numOpenedCells;
+
+	return numOpenedCells;
 }
 
-void UMinesweeperGame::ForEachCell(TFunctionRef<void(TSharedRef<FMinesweeperCell> InCell, const int32 InCellIndex, const FVector2D InCellCoord)> InFunc)
+
+int32 UMinesweeperGame::ParallelFloodFill()
 {
-	for (int32 cellIndex = 0; cellIndex < TotalCellCount(); ++cellIndex)
+	// large enough to amortize the task, small enough to balance a level over the workers
+	const int32 blockSize = 1024;
+
+	int32 numOpenedCells = 0;
+	TArray<int32> blockOpenedCells;
+
+	while (FloodFillStack.Num() > 0)
 	{
-		TSharedPtr<FMinesweeperCell> cell = GetCell(cellIndex);
-		if (cell.IsValid())
+		const int32 numBlocks = FMath::DivideAndRoundUp(FloodFillStack.Num(), blockSize);
+		if (FloodFillBlockFrontiers.Num() < numBlocks)
+		{
+			FloodFillBlockFrontiers.SetNum(numBlocks);
+			FloodFillBlockOpenedCells.SetNum(numBlocks);
+		}
+		blockOpenedCells.SetNumZeroed(numBlocks);
+
+		ParallelFor(numBlocks, [this, blockSize, &blockOpenedCells](const int32 InBlockIndex)
+			{
+				TArray<int32>& blockFrontier = FloodFillBlockFrontiers[InBlockIndex];
+				blockFrontier.Reset();
+
+				TArray<int32>& blockOpenedCellIndices = FloodFillBlockOpenedCells[InBlockIndex];
+				blockOpenedCellIndices.Reset();
+
+				// other blocks may be setting opened bits in the same bytes, only the mine bits are stable
+				auto readCell = [this](const int32 InPaddedIndex)
+				{
+					FMinesweeperCell cell;
+					const int8 cellByte = FPlatformAtomics::AtomicRead_Relaxed(reinterpret_cast<volatile const int8*>(&Cells[InPaddedIndex]));
+					FMemory::Memcpy(&cell, &cellByte, 1);
+					return cell;
+				};
+
+				const int32 firstIndex = InBlockIndex * blockSize;
+				const int32 lastIndex = FMath::Min(firstIndex + blockSize, FloodFillStack.Num());
+				for (int32 i = firstIndex; i < lastIndex; ++i)
+				{
+					for (const int32 neighborOffset : NeighborOffsets)
+					{
+						const int32 neighborIndex = FloodFillStack[i] + neighborOffset;
+						volatile int8* neighborByte = reinterpret_cast<volatile int8*>(&Cells[neighborIndex]);
+
+						// claim the cell by setting its opened bit with a compare exchange, so exactly one block opens it
+						// mines never change during a flood fill, so its count can be resolved before the exchange
+						FMinesweeperCell closedCell;
+						FMinesweeperCell openedCell;
+						int8 closedByte = FPlatformAtomics::AtomicRead(neighborByte);
+						do
+						{
+							FMemory::Memcpy(&closedCell, &closedByte, 1);
+							if (closedCell.bIsOpened) break;
+
+							openedCell = closedCell;
+							openedCell.bIsOpened = true;
+							if (!openedCell.HasKnownNeighborMineCount())
+							{
+								uint8 neighborMineCount = 0;
+								for (const int32 countOffset : NeighborOffsets)
+								{
+									neighborMineCount += readCell(neighborIndex + countOffset).bHasMine;
+								}
+								openedCell.NeighborMineCount = neighborMineCount;
+							}
+
+							int8 openedByte;
+							FMemory::Memcpy(&openedByte, &openedCell, 1);
+
+							const int8 previousByte = FPlatformAtomics::InterlockedCompareExchange(neighborByte, openedByte, closedByte);
+							if (previousByte == closedByte)
+							{
+								++blockOpenedCells[InBlockIndex];
+								if (bIsCollectingChangedCells)
+								{
+									blockOpenedCellIndices.Add(neighborIndex);
+								}
+
+								if (openedCell.NeighborMineCount == 0)
+								{
+									blockFrontier.Add(neighborIndex);
+								}
+								break;
+							}
+
+							closedByte = previousByte;
+						} while (true);
+					}
+				}
+			}, numBlocks == 1);
+
+		// the next level is every block's new cells in block order
+		FloodFillStack.Reset();
+		for (int32 blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
 		{
-			InFunc(cell.ToSharedRef(), cellIndex, FVector2D(cellIndex % Difficulty.Width, cellIndex / Difficulty.Width));
+			FloodFillStack.Append(FloodFillBlockFrontiers[blockIndex]);
+			numOpenedCells += blockOpenedCells[blockIndex];
+
+			if (bIsCollectingChangedCells)
+			{
+				ChangedCellIndices.Append(FloodFillBlockOpenedCells[blockIndex]);
+			}
 		}
 	}
+
+	return numOpenedCells;
 }
 
 
 bool UMinesweeperGame::IsTickable() const
 {
-	return IsActive && !IsPaused;
+	return ((IsActive && !IsPaused) || ChunkedBoard.HasPendingPageIns()) && !bIsFork;
 }
 
 void UMinesweeperGame::Tick(float InDeltaTime)
@@ -282,5 +1278,11 @@ void UMinesweeperGame::Tick(float InDeltaTime)
 	{
 		GameTime += InDeltaTime;
 	}
+
+	// chunks are only read back for the view, which drew them closed and is redrawn once they arrive
+	if (ChunkedBoard.InstallFinishedPageIns() > 0)
+	{
+		NotifyBoardChanged();
+	}
 }
 
@@ -0,0 +1,30 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperGameSnapshot.h"
+
+
+
+
+int32 FMinesweeperGameSnapshot::NumSharedPages() const
+{
+	int32 numShared = 0;
+	for (const TSharedPtr<const FPage, ESPMode::ThreadSafe>& page : Pages)
+	{
+		if (page.GetSharedReferenceCount() > 1)
+		{
+			++numShared;
+		}
+	}
+	return numShared;
+}
+
+
+SIZE_T FMinesweeperGameSnapshot::GetAllocatedSize() const
+{
+	SIZE_T allocatedSize = Pages.GetAllocatedSize() + PreStartFlagCellIndices.GetAllocatedSize();
+	for (const TSharedPtr<const FPage, ESPMode::ThreadSafe>& page : Pages)
+	{
+		allocatedSize += sizeof(FPage) + page->GetAllocatedSize();
+	}
+	return allocatedSize;
+}
@@ -6,11 +6,89 @@
 #include "UObject/ConstructorHelpers.h"
 #include "Engine/Canvas.h"
 #include "CanvasItem.h"
+#include "RenderUtils.h"
+#include "RenderingThread.h"
+#include "UObject/Package.h"
+#include "UObject/SoftObjectPath.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "ImageUtils.h"
 
 
 //#define DEFINE_DEBUG_MINES // will always show all mines and neighbor mine count texts on the grid if defined
 
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Grid Canvas Redraws"), STAT_MinesweeperGridCanvasRedraws, STATGROUP_Minesweeper);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Grid Canvas Cells Drawn"), STAT_MinesweeperGridCanvasCellsDrawn, STATGROUP_Minesweeper);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Grid Canvas Draw Batches"), STAT_MinesweeperGridCanvasDrawBatches, STATGROUP_Minesweeper);
+
+
+
+
+namespace MinesweeperGridCanvas
+{
+	/** Slots of the sprite atlas, the digit slots hold the neighbor mine counts 1 to 8 in order. */
+	enum class ESprite : int32
+	{
+		ClosedCell,
+		OpenCell,
+		OpenCellMine,
+		Mine,
+		Flag,
+		HoverCell,
+		Digit1,
+		Count = Digit1 + 8
+	};
+
+	static constexpr int32 AtlasSlotSize = 64;
+	static constexpr int32 AtlasSlotsPerRow = 4;
+	static constexpr int32 AtlasSize = AtlasSlotSize * AtlasSlotsPerRow;
+	static_assert((int32)ESprite::Count <= AtlasSlotsPerRow * AtlasSlotsPerRow, "Sprite atlas is too small for its slots");
+
+	/** Triangles per batch, a full 2048 pixel view of the smallest cells takes a few. */
+	static constexpr int32 MaxTrianglesPerBatch = 8192;
+
+	static FORCEINLINE FVector2D GetSlotPosition(const ESprite InSprite)
+	{
+		return FVector2D(((int32)InSprite % AtlasSlotsPerRow) * AtlasSlotSize, ((int32)InSprite / AtlasSlotsPerRow) * AtlasSlotSize);
+	}
+
+	/**
+	 * Appends the two triangles of a cell sized quad showing the top left InSpriteSize texels of a slot, the whole slot by default.
+	 * UVs are inset by half a texel so filtering never reads the neighboring slot.
+	 */
+	static FORCEINLINE void AddQuad(TArray<FCanvasUVTri>& OutTriangles, const FVector2D& InPosition, const float InSize, const ESprite InSprite, const FLinearColor& InColor, const float InSpriteSize = AtlasSlotSize)
+	{
+		const FVector2D slotPosition = GetSlotPosition(InSprite);
+		const FVector2D uv0 = (slotPosition + FVector2D(0.5f)) / AtlasSize;
+		const FVector2D uv1 = (slotPosition + FVector2D(InSpriteSize - 0.5f)) / AtlasSize;
+		const FVector2D position1 = InPosition + FVector2D(InSize);
+
+		FCanvasUVTri& upperTriangle = OutTriangles.AddDefaulted_GetRef();
+		upperTriangle.V0_Pos = InPosition; upperTriangle.V0_UV = uv0; upperTriangle.V0_Color = InColor;
+		upperTriangle.V1_Pos = FVector2D(position1.X, InPosition.Y); upperTriangle.V1_UV = FVector2D(uv1.X, uv0.Y); upperTriangle.V1_Color = InColor;
+		upperTriangle.V2_Pos = position1; upperTriangle.V2_UV = uv1; upperTriangle.V2_Color = InColor;
+
+		FCanvasUVTri& lowerTriangle = OutTriangles.AddDefaulted_GetRef();
+		lowerTriangle.V0_Pos = InPosition; lowerTriangle.V0_UV = uv0; lowerTriangle.V0_Color = InColor;
+		lowerTriangle.V1_Pos = position1; lowerTriangle.V1_UV = uv1; lowerTriangle.V1_Color = InColor;
+		lowerTriangle.V2_Pos = FVector2D(InPosition.X, position1.Y); lowerTriangle.V2_UV = FVector2D(uv0.X, uv1.Y); lowerTriangle.V2_Color = InColor;
+	}
+
+	static void DrawTriangles(UCanvas* InCanvas, const TArray<FCanvasUVTri>& InTriangles, const FTexture* InTexture, const ESimpleElementBlendMode InBlendMode)
+	{
+		if (InTriangles.Num() == 0) return;
+
+		FCanvasTriangleItem triangleItem(InTriangles, InTexture);
+		triangleItem.BlendMode = InBlendMode;
+		InCanvas->DrawItem(triangleItem);
+
+		INC_DWORD_STAT(STAT_MinesweeperGridCanvasDrawBatches);
+	}
+}
+
+
 
 
 UMinesweeperGridCanvas::UMinesweeperGridCanvas()
@@ -33,8 +111,12 @@ UMinesweeperGridCanvas::UMinesweeperGridCanvas()
 void UMinesweeperGridCanvas::InitCanvas(UMinesweeperGame* InGame, const float InCellDrawSize)
 {
 	Game = InGame;
+	bNeedsFullRedraw = true;
+
+	UpdateNeighborMineCountPalette();
 
 	SetCellDrawSize(InCellDrawSize);
+	SetViewOrigin(ViewOrigin.X, ViewOrigin.Y);
 
 	UpdateResource();
 }
@@ -42,25 +124,161 @@ void UMinesweeperGridCanvas::InitCanvas(UMinesweeperGame* InGame, const float In
 
 int32 UMinesweeperGridCanvas::GridPositionToCellIndex(UPARAM(ref) const FVector2D& InGridPosition) const
 {
-	return Game == nullptr ? -1 : Game->GridCoordToIndex(FIntVector2(InGridPosition.X / CellDrawSize, InGridPosition.Y / CellDrawSize));
+	return Game == nullptr ? -1 : Game->GridCoordToIndex(FIntVector2(ViewOrigin.X + (int32)(InGridPosition.X / CellDrawSize), ViewOrigin.Y + (int32)(InGridPosition.Y / CellDrawSize)));
 }
 
 void UMinesweeperGridCanvas::GridPositionToCellCoord(const FVector2D& GridPosition, int32& CellX, int32& CellY) const
 {
-	CellX = Game == nullptr ? -1 : GridPosition.X / CellDrawSize;
-	CellY = Game == nullptr ? -1 : GridPosition.Y / CellDrawSize;
+	CellX = Game == nullptr ? -1 : ViewOrigin.X + (int32)(GridPosition.X / CellDrawSize);
+	CellY = Game == nullptr ? -1 : ViewOrigin.Y + (int32)(GridPosition.Y / CellDrawSize);
+}
+
+
+void UMinesweeperGridCanvas::GetViewOrigin(int32& CellX, int32& CellY) const
+{
+	CellX = ViewOrigin.X;
+	CellY = ViewOrigin.Y;
+}
+
+void UMinesweeperGridCanvas::SetViewOrigin(const int32 CellX, const int32 CellY)
+{
+	if (!Game) return;
+
+	// unbounded boards can be scrolled anywhere
+	if (Game->GetDifficulty().bUnbounded)
+	{
+		bNeedsFullRedraw |= ViewOrigin != FIntVector2(CellX, CellY);
+		ViewOrigin = FIntVector2(CellX, CellY);
+		return;
+	}
+
+	const FIntVector2 gridSize = Game->GetDifficulty().GridSize();
+	const FIntVector2 viewCellCount = ComputeViewCellCount(gridSize, CellDrawSize);
+
+	const FIntVector2 viewOrigin(FMath::Clamp(CellX, 0, gridSize.X - viewCellCount.X), FMath::Clamp(CellY, 0, gridSize.Y - viewCellCount.Y));
+	bNeedsFullRedraw |= viewOrigin != ViewOrigin;
+	ViewOrigin = viewOrigin;
+}
+
+void UMinesweeperGridCanvas::GetViewCellCount(int32& CellCountX, int32& CellCountY) const
+{
+	const FIntVector2 viewCellCount = Game == nullptr ? FIntVector2(0, 0) : ComputeViewCellCount(Game->GetDifficulty().GridSize(), CellDrawSize);
+	CellCountX = viewCellCount.X;
+	CellCountY = viewCellCount.Y;
+}
+
+FIntVector2 UMinesweeperGridCanvas::ComputeViewCellCount(const FIntVector2& InGridSize, const float InCellDrawSize)
+{
+	const int32 maxCellCount = FMath::Max(1, FMath::FloorToInt32(MaxCanvasSize() / FMath::Max(InCellDrawSize, 1.0f)));
+	return FIntVector2(FMath::Min(InGridSize.X, maxCellCount), FMath::Min(InGridSize.Y, maxCellCount));
 }
 
 
 void UMinesweeperGridCanvas::SetCellDrawSize(const float InCellDrawSize)
 {
-	CellDrawSize = FMath::Clamp(InCellDrawSize, 10.0f, 64.0f);
+	const float cellDrawSize = FMath::Clamp(InCellDrawSize, 10.0f, 64.0f);
+	bNeedsFullRedraw |= cellDrawSize != CellDrawSize;
+	CellDrawSize = cellDrawSize;
 }
 
 
+void UMinesweeperGridCanvas::ClearHoverCell()
+{
+	if (bHasHoverCell)
+	{
+		MarkCellDirty(HoverCellCoord);
+	}
+
+	bHasHoverCell = false;
+}
+
+void UMinesweeperGridCanvas::SetHoverCellIndex(const int32 CellIndex)
+{
+	if (Game != nullptr && Game->IsValidGridIndex(CellIndex))
+	{
+		const FIntVector2 cellCoord = Game->GridIndexToCoord(CellIndex);
+		SetHoverCellCoord(cellCoord.X, cellCoord.Y);
+	}
+	else
+	{
+		ClearHoverCell();
+	}
+}
+
 void UMinesweeperGridCanvas::SetHoverCellCoord(const int32 CellX, const int32 CellY)
 {
-	HoverCellIndex = Game == nullptr ? -1 : Game->GridCoordToIndex(FIntVector2(CellX, CellY));
+	const bool bHadHoverCell = bHasHoverCell;
+	const FIntVector2 oldHoverCellCoord = HoverCellCoord;
+
+	bHasHoverCell = Game != nullptr && Game->IsValidGridCoord((int64)CellX, (int64)CellY);
+	HoverCellCoord = FIntVector2(CellX, CellY);
+
+	if (bHadHoverCell == bHasHoverCell && oldHoverCellCoord == HoverCellCoord) return;
+
+	if (bHadHoverCell)
+	{
+		MarkCellDirty(oldHoverCellCoord);
+	}
+	if (bHasHoverCell)
+	{
+		MarkCellDirty(HoverCellCoord);
+	}
+}
+
+
+FLinearColor UMinesweeperGridCanvas::GetHoverCellColor(const int32 CellX, const int32 CellY) const
+{
+	const FMinesweeperCell* cell = Game ? Game->TryGetCellAt(CellX, CellY) : nullptr;
+	return cell && cell->bIsOpened ? HoverCellInvalidColor : HoverCellValidColor;
+}
+
+
+void UMinesweeperGridCanvas::MarkCellDirty(const FIntVector2& InCellCoord)
+{
+	if (!Game) return;
+
+	const FIntVector2 viewCellCount = ComputeViewCellCount(Game->GetDifficulty().GridSize(), CellDrawSize);
+	if (InCellCoord.X < ViewOrigin.X || InCellCoord.Y < ViewOrigin.Y || InCellCoord.X >= ViewOrigin.X + viewCellCount.X || InCellCoord.Y >= ViewOrigin.Y + viewCellCount.Y) return;
+
+	DirtyCellCoords.Add(InCellCoord);
+}
+
+void UMinesweeperGridCanvas::UpdateResource()
+{
+	// the atlas is drawn before the cells, it cannot be updated from inside this canvas update
+	UpdateSpriteAtlasSources();
+
+	Super::UpdateResource();
+}
+
+void UMinesweeperGridCanvas::RedrawChangedCells()
+{
+	if (!Game) return;
+
+	UpdateSpriteAtlasSources();
+
+	if (bNeedsFullRedraw || Game->AreAllCellsDirty())
+	{
+		UpdateResource();
+		return;
+	}
+
+	for (const int32 cellIndex : Game->GetDirtyCellIndices())
+	{
+		MarkCellDirty(Game->GridIndexToCoord(cellIndex));
+	}
+
+	if (DirtyCellCoords.Num() == 0) return;
+
+	// draw over what the render target already holds instead of clearing it
+	const bool bShouldClear = bShouldClearRenderTargetOnReceiveUpdate;
+	bShouldClearRenderTargetOnReceiveUpdate = false;
+	bIsDrawingDirtyCells = true;
+
+	RepaintCanvas();
+
+	bIsDrawingDirtyCells = false;
+	bShouldClearRenderTargetOnReceiveUpdate = bShouldClear;
 }
 
 
@@ -69,92 +287,268 @@ FSlateColor UMinesweeperGridCanvas::GetNeighborMineCountColor_Implementation(con
 	return DefaultNeighborMineCountColor(InMineCount);
 }
 
+FLinearColor UMinesweeperGridCanvas::GetCachedNeighborMineCountColor(const int32 MineCount)
+{
+	UpdateNeighborMineCountPalette();
+	return NeighborMineCountPalette.IsValidIndex(MineCount) ? NeighborMineCountPalette[MineCount] : FLinearColor::White;
+}
+
+void UMinesweeperGridCanvas::InvalidateNeighborMineCountPalette()
+{
+	NeighborMineCountPalette.Reset();
+	bNeedsFullRedraw = true;
+}
+
+void UMinesweeperGridCanvas::UpdateNeighborMineCountPalette()
+{
+	if (NeighborMineCountPalette.Num() == 9 && NeighborMineCountPaletteClass == GetClass()) return;
+
+	NeighborMineCountPalette.Reset();
+	for (int32 mineCount = 0; mineCount <= 8; ++mineCount)
+	{
+		NeighborMineCountPalette.Add(GetNeighborMineCountColor(mineCount).GetSpecifiedColor());
+	}
+	NeighborMineCountPaletteClass = GetClass();
+
+	// a changed palette redraws the atlas digits and then every cell
+	bNeedsFullRedraw = true;
+}
+
+
+void UMinesweeperGridCanvas::UpdateSpriteAtlasSources()
+{
+	const TArray<UObject*> sources = { ClosedCellTexture, OpenCellTexture, OpenCellMineTexture, MineTexture, FlagTexture, HoverCellTexture, CellFont };
+
+	UpdateNeighborMineCountPalette();
+
+	TArray<FLinearColor, TInlineAllocator<8>> digitColors;
+	for (int32 mineCount = 1; mineCount <= 8; ++mineCount)
+	{
+		digitColors.Add(NeighborMineCountPalette[mineCount]);
+	}
+
+	if (SpriteAtlas && SpriteAtlasSources == sources && SpriteAtlasDigitSize == CellDrawSize && SpriteAtlasDigitColors == digitColors) return;
+
+	SpriteAtlasSources = sources;
+	SpriteAtlasDigitSize = CellDrawSize;
+	SpriteAtlasDigitColors = digitColors;
+
+	// cells drawn from the old sprites must not stay next to ones drawn from the new
+	bNeedsFullRedraw = true;
+
+	if (!SpriteAtlas)
+	{
+		SpriteAtlas = UCanvasRenderTarget2D::CreateCanvasRenderTarget2D(GetTransientPackage(), UCanvasRenderTarget2D::StaticClass(), MinesweeperGridCanvas::AtlasSize, MinesweeperGridCanvas::AtlasSize);
+		if (!SpriteAtlas) return;
+
+		// empty slots and glyph edges stay transparent
+		SpriteAtlas->ClearColor = FLinearColor::Transparent;
+		SpriteAtlas->OnCanvasRenderTargetUpdate.AddDynamic(this, &UMinesweeperGridCanvas::UpdateSpriteAtlas);
+	}
+
+	SpriteAtlas->UpdateResource();
+}
+
+void UMinesweeperGridCanvas::UpdateSpriteAtlas(UCanvas* InCanvas, const int32 InWidth, const int32 InHeight)
+{
+	using namespace MinesweeperGridCanvas;
+
+	if (!InCanvas) return;
+
+	auto drawSprite = [&](const ESprite InSprite, const UTexture2D* InTexture)
+		{
+			if (!InTexture) return;
+
+			// copied as is, translucency is applied when the cell is drawn
+			FCanvasTileItem tileItem(GetSlotPosition(InSprite), InTexture->GetResource(), FVector2D(AtlasSlotSize), FLinearColor::White);
+			tileItem.BlendMode = SE_BLEND_Opaque;
+			InCanvas->DrawItem(tileItem);
+		};
+
+	drawSprite(ESprite::ClosedCell, ClosedCellTexture);
+	drawSprite(ESprite::OpenCell, OpenCellTexture);
+	drawSprite(ESprite::OpenCellMine, OpenCellMineTexture);
+	drawSprite(ESprite::Mine, MineTexture);
+	drawSprite(ESprite::Flag, FlagTexture);
+	drawSprite(ESprite::HoverCell, HoverCellTexture);
+
+	if (!CellFont) return;
+
+	// digits are laid out for the cell draw size and drawn in their color, cells then copy them as is
+	for (int32 mineCount = 1; mineCount <= 8 && mineCount <= SpriteAtlasDigitColors.Num(); ++mineCount)
+	{
+		const TCHAR digit[2] = { (TCHAR)(TEXT('0') + mineCount), 0 };
+
+		float charWidth, charHeight;
+		CellFont->GetCharSize(digit[0], charWidth, charHeight);
+		if (charHeight <= 0.0f) continue;
+
+		const FLinearColor& digitColor = SpriteAtlasDigitColors[mineCount - 1];
+		const FVector2D slotPosition = GetSlotPosition((ESprite)((int32)ESprite::Digit1 + mineCount - 1));
+
+		// the slot is filled with the digit color at zero alpha, so blending the glyph over it leaves the color as is and its coverage in alpha
+		// translucent blending would keep the cleared alpha and the cell batch would draw nothing of the digit
+		FCanvasTileItem fillTileItem(slotPosition, FVector2D(AtlasSlotSize), FLinearColor(digitColor.R, digitColor.G, digitColor.B, 0.0f));
+		fillTileItem.BlendMode = SE_BLEND_Opaque;
+		InCanvas->DrawItem(fillTileItem);
+
+		const float percentOfCellSize = 0.8f;
+		const FVector2D textPosition = slotPosition + FVector2D((charWidth * 0.5f) * percentOfCellSize, (charHeight * 0.5f) * 0.2f);
+
+		FCanvasTextItem textItem(textPosition, FText::FromString(digit), CellFont, digitColor);
+		textItem.Scale = FVector2D((SpriteAtlasDigitSize / charHeight) * percentOfCellSize);
+		textItem.BlendMode = SE_BLEND_AlphaBlend;
+		InCanvas->DrawItem(textItem);
+	}
+}
+
 
 void UMinesweeperGridCanvas::UpdateCanvas(UCanvas* InCanvas, const int32 InWidth, const int32 InHeight)
 {
+	using namespace MinesweeperGridCanvas;
+
 	if (!InCanvas || !Game) return;
 	if (!ClosedCellTexture || !FlagTexture || !MineTexture || !OpenCellTexture) return;
 
+	if (!SpriteAtlas) return;
+
+	LastDrawnCellCount = 0;
+	CellTriangles.Reset();
+	ClearTriangles.Reset();
+
+	// every sprite comes from the atlas, so the cells only break into batches when there are too many triangles for one
+	auto flushTriangles = [&]()
+		{
+			DrawTriangles(InCanvas, ClearTriangles, GWhiteTexture, SE_BLEND_Opaque);
+			DrawTriangles(InCanvas, CellTriangles, SpriteAtlas->GetResource(), SE_BLEND_Translucent);
+			ClearTriangles.Reset();
+			CellTriangles.Reset();
+		};
 
-	auto DrawCell = [&](const FVector2D& InPosition, const UTexture2D* InTexture, FVector2D InSize = FVector2D::ZeroVector, const FLinearColor InColor = FLinearColor(1.0f, 1.0f, 1.0f))
-	{
-		if (InSize == FVector2D::ZeroVector) InSize = FVector2D(CellDrawSize);
-		FCanvasTileItem canvasTileItem(InPosition, InTexture->GetResource(), InSize, InColor);
-		canvasTileItem.BlendMode = SE_BLEND_Translucent;
-		InCanvas->DrawItem(canvasTileItem);
-	};
 
+	// draw the minesweeper grid cells inside the view window
+	const FIntVector2 viewCellCount = ComputeViewCellCount(Game->GetDifficulty().GridSize(), CellDrawSize);
+	const FIntVector2 viewEnd(ViewOrigin.X + viewCellCount.X, ViewOrigin.Y + viewCellCount.Y);
 
-	// draw the minesweeper grid
-	Game->ForEachCell([&](const TSharedPtr<FMinesweeperCell> InCell, const int32 InCellIndex, const FVector2D InCellCoord)
+	auto drawGridCell = [&](const FMinesweeperCell& InCell, const FIntVector2& InCellCoord)
 		{
-			const FVector2D cellPosition = InCellCoord * CellDrawSize;
+			const FVector2D cellPosition((InCellCoord.X - ViewOrigin.X) * CellDrawSize, (InCellCoord.Y - ViewOrigin.Y) * CellDrawSize);
+			++LastDrawnCellCount;
+
+
+			// cells drawn over the retained canvas are cleared first, as the whole canvas is before a full update
+			if (bIsDrawingDirtyCells)
+			{
+				AddQuad(ClearTriangles, cellPosition, CellDrawSize, ESprite::ClosedCell, ClearColor);
+			}
 
 
 			// draw open/closed cell background
 			{
-				UTexture2D* backgroundTexture = ClosedCellTexture;
-				if (InCell->bIsOpened)
+				ESprite backgroundSprite = ESprite::ClosedCell;
+				if (InCell.bIsOpened)
 				{
-					backgroundTexture = InCell->bHasMine ? OpenCellMineTexture : OpenCellTexture;
+					backgroundSprite = InCell.bHasMine ? ESprite::OpenCellMine : ESprite::OpenCell;
 				}
-				DrawCell(cellPosition, backgroundTexture);
+				AddQuad(CellTriangles, cellPosition, CellDrawSize, backgroundSprite, FLinearColor::White);
 			}
 
 
-			// draw neighbor mine count text
+			// draw neighbor mine count digit
 #ifdef DEFINE_DEBUG_MINES
-			const bool drawNeighborMineCount = true;
+			const bool drawNeighborMineCount = InCell.HasKnownNeighborMineCount();
 #else
-			const bool drawNeighborMineCount = InCell->bIsOpened && !InCell->bHasMine && InCell->NeighborMineCount > 0;
+			const bool drawNeighborMineCount = InCell.bIsOpened && !InCell.bHasMine && InCell.NeighborMineCount > 0;
 #endif
 			if (CellFont && drawNeighborMineCount)
 			{
-				FString neighborMineCountStr = FString::FromInt(InCell->NeighborMineCount);
-				FText neighborMineCountText = FText::FromString(neighborMineCountStr);
-				
-				float outWidth, outHeight;
-				CellFont->GetCharSize(neighborMineCountStr[0], outWidth, outHeight);
-				int32 textWidth = CellFont->GetStringSize(*neighborMineCountStr);
-
-				const float percentOfCellSize = 0.8f;
-
-				FVector2D textPosition = cellPosition + FVector2D((outWidth * 0.5f) * percentOfCellSize, (outHeight * 0.5f) * 0.2f);
-				
-				float scale = (CellDrawSize / outHeight) * percentOfCellSize;
-
-				FCanvasTextItem textItem(textPosition, neighborMineCountText, CellFont, GetNeighborMineCountColor(InCell->NeighborMineCount).GetSpecifiedColor());
-				textItem.Scale = FVector2D(scale);
-				textItem.BlendMode = SE_BLEND_Translucent;
-				InCanvas->DrawItem(textItem);
+				const ESprite digitSprite = (ESprite)((int32)ESprite::Digit1 + InCell.NeighborMineCount - 1);
+				AddQuad(CellTriangles, cellPosition, CellDrawSize, digitSprite, FLinearColor::White, SpriteAtlasDigitSize);
 			}
 
 			
 			// draw mine
 #ifdef DEFINE_DEBUG_MINES
-			const bool drawMine = InCell->bHasMine;
+			const bool drawMine = InCell.bHasMine;
 #else
-			const bool drawMine = InCell->bHasMine && Game->IsGameOver();
+			const bool drawMine = InCell.bHasMine && Game->IsGameOver();
 #endif
 			if (drawMine)
 			{
-				DrawCell(cellPosition, MineTexture);
+				AddQuad(CellTriangles, cellPosition, CellDrawSize, ESprite::Mine, FLinearColor::White);
 			}
 
 
 			// draw flag
-			if (!InCell->bIsOpened && InCell->bIsFlagged)
+			if (!InCell.bIsOpened && InCell.bIsFlagged)
 			{
-				DrawCell(cellPosition, FlagTexture);
+				AddQuad(CellTriangles, cellPosition, CellDrawSize, ESprite::Flag, FLinearColor::White);
 			}
 
 
 			// draw hover cell outline
-			if (HoverCellIndex > -1 && InCellIndex == HoverCellIndex)
+			if (bHasHoverCell && InCellCoord.X == HoverCellCoord.X && InCellCoord.Y == HoverCellCoord.Y)
+			{
+				AddQuad(CellTriangles, cellPosition, CellDrawSize, ESprite::HoverCell, InCell.bIsOpened ? HoverCellInvalidColor : HoverCellValidColor);
+			}
+
+			if (CellTriangles.Num() >= MaxTrianglesPerBatch)
+			{
+				flushTriangles();
+			}
+		};
+
+	const FMinesweeperCell closedCell;
+	auto drawGridCellAt = [&](const int32 InCellX, const int32 InCellY)
+		{
+			// creates the chunks of unbounded boards that come into view
+			const FMinesweeperCell* cell = Game->TryGetCellAt(InCellX, InCellY);
+			if (cell)
+			{
+				drawGridCell(*cell, FIntVector2(InCellX, InCellY));
+			}
+			else if (Game->IsValidGridCoord((int64)InCellX, (int64)InCellY))
 			{
-				DrawCell(cellPosition, HoverCellTexture, FVector2D::ZeroVector, InCell->bIsOpened ? HoverCellInvalidColor : HoverCellValidColor);
+				drawGridCell(closedCell, FIntVector2(InCellX, InCellY));
 			}
-		});
+		};
+
+	if (bIsDrawingDirtyCells)
+	{
+		// a cell may be listed more than once, drawing it again is cheaper than sorting the list
+		for (const FIntVector2& cellCoord : DirtyCellCoords)
+		{
+			drawGridCellAt(cellCoord.X, cellCoord.Y);
+		}
+	}
+	else
+	{
+		// unbounded boards read paged out chunks back in the background and draw them closed until they arrive
+		Game->PrefetchCells(ViewOrigin.X, ViewOrigin.Y, viewEnd.X - 1, viewEnd.Y - 1);
+
+		CellTriangles.Reserve(FMath::Min(viewCellCount.X * viewCellCount.Y * 2, MaxTrianglesPerBatch + 8));
+
+		for (int32 y = ViewOrigin.Y; y < viewEnd.Y; ++y)
+		{
+			for (int32 x = ViewOrigin.X; x < viewEnd.X; ++x)
+			{
+				drawGridCellAt(x, y);
+			}
+		}
+
+		// scrolling creates and reads back chunks without any game action to page them out again
+		Game->TrimResidentChunks();
+
+		bNeedsFullRedraw = false;
+	}
+
+	flushTriangles();
+
+	DirtyCellCoords.Reset();
+	++RedrawCount;
+
+	INC_DWORD_STAT(STAT_MinesweeperGridCanvasRedraws);
+	INC_DWORD_STAT_BY(STAT_MinesweeperGridCanvasCellsDrawn, LastDrawnCellCount);
 }
 
 
@@ -173,3 +567,94 @@ FSlateColor UMinesweeperGridCanvas::DefaultNeighborMineCountColor(const int32 In
 	}
 	return FLinearColor::White;
 }
+
+
+
+
+// Developer console command writing the sprite atlas and a drawn board to Saved/Minesweeper, to check the rasterized digits by eye.
+#if !UE_BUILD_SHIPPING
+
+namespace MinesweeperGridCanvas
+{
+	/** Writes a render target to Saved/Minesweeper/InFileName.png. */
+	static void ExportRenderTargetAsPNG(UTextureRenderTarget2D* InRenderTarget, const FString& InFileName)
+	{
+		if (!InRenderTarget) return;
+
+		const FString filePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Minesweeper"), InFileName + TEXT(".png"));
+		TUniquePtr<FArchive> fileWriter(IFileManager::Get().CreateFileWriter(*filePath));
+		if (!fileWriter || !FImageUtils::ExportRenderTarget2DAsPNG(InRenderTarget, *fileWriter))
+		{
+			UE_LOG(LogMinesweeperRuntime, Warning, TEXT("Could not export %s"), *filePath);
+			return;
+		}
+
+		UE_LOG(LogMinesweeperRuntime, Display, TEXT("Exported %s"), *FPaths::ConvertRelativePathToFull(filePath));
+	}
+
+	static void ExportSpriteAtlas(const TArray<FString>& InArgs)
+	{
+		// canvas classes overriding GetNeighborMineCountColor, e.g. blueprints, are passed by path to check their palettes too
+		TArray<UClass*> canvasClasses = { UMinesweeperGridCanvas::StaticClass() };
+		for (const FString& classPath : InArgs)
+		{
+			UClass* canvasClass = FSoftClassPath(classPath).TryLoadClass<UMinesweeperGridCanvas>();
+			if (!canvasClass)
+			{
+				UE_LOG(LogMinesweeperRuntime, Warning, TEXT("%s is not a grid canvas class"), *classPath);
+				continue;
+			}
+			canvasClasses.AddUnique(canvasClass);
+		}
+
+		// a lost game shows every sprite: open cells, digits, flags and mines
+		UMinesweeperGame* game = NewObject<UMinesweeperGame>(GetTransientPackage());
+		game->SetupGame(FMinesweeperDifficulty::Expert());
+		game->TryOpenCell(game->GetDifficulty().Width / 2, game->GetDifficulty().Height / 2);
+
+		int32 closedCellCount = 0;
+		FIntVector2 mineCellCoord(-1, -1);
+		for (const TMinesweeperCellRange<const FMinesweeperCell>::FElement element : static_cast<const UMinesweeperGame*>(game)->GetCells())
+		{
+			if (element.Cell.bIsOpened) continue;
+
+			if (element.Cell.bHasMine && mineCellCoord.X < 0)
+			{
+				mineCellCoord = element.Coord;
+			}
+			else if (++closedCellCount % 4 == 0)
+			{
+				game->TryFlagCell(element.Coord.X, element.Coord.Y);
+			}
+		}
+		game->TryOpenCell(mineCellCoord.X, mineCellCoord.Y);
+
+		// the smallest, default and largest cell draw sizes, digits are rasterized once per size
+		const float cellDrawSizes[] = { 10.0f, UMinesweeperGridCanvas::DefaultCellDrawSize(), 64.0f };
+
+		for (UClass* canvasClass : canvasClasses)
+		{
+			for (const float cellDrawSize : cellDrawSizes)
+			{
+				const FIntVector2 viewCellCount = UMinesweeperGridCanvas::ComputeViewCellCount(game->GetDifficulty().GridSize(), cellDrawSize);
+				UMinesweeperGridCanvas* gridCanvas = CastChecked<UMinesweeperGridCanvas>(
+					UCanvasRenderTarget2D::CreateCanvasRenderTarget2D(GetTransientPackage(), canvasClass, viewCellCount.X * cellDrawSize, viewCellCount.Y * cellDrawSize));
+
+				gridCanvas->InitCanvas(game, cellDrawSize);
+				gridCanvas->UpdateResource();
+				FlushRenderingCommands();
+
+				const FString fileName = FString::Printf(TEXT("%s_%d"), *canvasClass->GetName(), FMath::RoundToInt(cellDrawSize));
+				ExportRenderTargetAsPNG(gridCanvas->GetSpriteAtlas(), fileName + TEXT("_Atlas"));
+				ExportRenderTargetAsPNG(gridCanvas, fileName + TEXT("_Grid"));
+			}
+		}
+	}
+
+	static FAutoConsoleCommand ExportSpriteAtlasCommand(
+		TEXT("Minesweeper.Debug.ExportSpriteAtlas"),
+		TEXT("Writes the sprite atlas and a lost expert board drawn at cell sizes 10, 28 and 64 as pngs to Saved/Minesweeper. Optional arguments are grid canvas class paths, e.g. blueprints with their own digit palette."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&ExportSpriteAtlas));
+}
+
+#endif // !UE_BUILD_SHIPPING
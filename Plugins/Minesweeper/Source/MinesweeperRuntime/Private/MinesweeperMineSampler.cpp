@@ -0,0 +1,154 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperMineSampler.h"
+#include "MinesweeperBitBoard.h"
+
+
+
+
+void FMinesweeperMineSampler::SampleMines(FRandomStream& InRandStream, const int32 InTotalCellCount, TConstArrayView<int32> InExcludedCellIndices, const int32 InMineCount, TArray<int32>& OutMineCellIndices)
+{
+	OutMineCellIndices.Reset();
+
+	const int32 candidateCount = FMath::Max(0, InTotalCellCount - InExcludedCellIndices.Num());
+	const int32 mineCount = FMath::Clamp(InMineCount, 0, candidateCount);
+	if (mineCount == 0) return;
+
+	OutMineCellIndices.Reserve(mineCount);
+
+	TArray<int32> sampledRanks;
+
+	if (mineCount * 2 <= candidateCount)
+	{
+		// sparse board, sample the mines directly
+		SampleRanks(InRandStream, candidateCount, mineCount, sampledRanks);
+
+		for (const int32 rank : sampledRanks)
+		{
+			OutMineCellIndices.Add(RankToCellIndex(rank, InExcludedCellIndices));
+		}
+	}
+	else
+	{
+		// dense board, sample the mine free cells and place mines everywhere else
+		// more than half of the candidates are mines here so walking every candidate is still O(mines)
+		SampleRanks(InRandStream, candidateCount, candidateCount - mineCount, sampledRanks);
+
+		TBitArray<> isSafeRank(false, candidateCount);
+		for (const int32 rank : sampledRanks)
+		{
+			isSafeRank[rank] = true;
+		}
+
+		int32 excludedIndex = 0;
+		int32 rank = 0;
+		for (int32 cellIndex = 0; cellIndex < InTotalCellCount; ++cellIndex)
+		{
+			if (excludedIndex < InExcludedCellIndices.Num() && InExcludedCellIndices[excludedIndex] == cellIndex)
+			{
+				++excludedIndex;
+				continue;
+			}
+
+			if (!isSafeRank[rank++])
+			{
+				OutMineCellIndices.Add(cellIndex);
+			}
+		}
+	}
+}
+
+
+void FMinesweeperMineSampler::SampleMines(FRandomStream& InRandStream, FMinesweeperBitBoard& InOutBitBoard, const int32 InMineCount)
+{
+	const int32 totalCellCount = InOutBitBoard.Width * InOutBitBoard.Height;
+	const int32 mineCount = FMath::Clamp(InMineCount, 0, totalCellCount);
+	if (mineCount == 0) return;
+
+	// dense board, start from a full plane and draw the mine free cells instead
+	const bool bSampleSafeCells = mineCount * 2 > totalCellCount;
+	const int32 sampleCount = bSampleSafeCells ? totalCellCount - mineCount : mineCount;
+
+	if (bSampleSafeCells)
+	{
+		const uint64 lastWordMask = (InOutBitBoard.Width & 63) == 0 ? ~0ull : (1ull << (InOutBitBoard.Width & 63)) - 1;
+		for (int32 y = 0; y < InOutBitBoard.Height; ++y)
+		{
+			uint64* row = InOutBitBoard.MinePlane.GetData() + (y * InOutBitBoard.WordsPerRow);
+			for (int32 w = 0; w < InOutBitBoard.WordsPerRow; ++w)
+			{
+				row[w] = w + 1 < InOutBitBoard.WordsPerRow ? ~0ull : lastWordMask;
+			}
+		}
+	}
+
+	// at most half of the cells are taken at any time, so each sample is accepted with a probability of at least one half
+	for (int32 i = 0; i < sampleCount; )
+	{
+		const int32 cellIndex = RandIndex(InRandStream, totalCellCount);
+		const int32 x = cellIndex % InOutBitBoard.Width;
+		const int32 y = cellIndex / InOutBitBoard.Width;
+
+		if (InOutBitBoard.HasMine(x, y) != bSampleSafeCells) continue;
+
+		InOutBitBoard.MinePlane[InOutBitBoard.WordIndex(x, y)] ^= FMinesweeperBitBoard::BitMask(x);
+		++i;
+	}
+}
+
+
+int32 FMinesweeperMineSampler::RandIndex(FRandomStream& InRandStream, const int32 InCount)
+{
+	if (InCount <= 1) return 0;
+
+	// RandRange scales a float fraction, which can't reach every index of a large range
+	if (InCount < (1 << 24)) return InRandStream.RandRange(0, InCount - 1);
+
+	return (int32)(((uint64)InRandStream.GetUnsignedInt() * (uint64)InCount) >> 32);
+}
+
+
+void FMinesweeperMineSampler::SampleRanks(FRandomStream& InRandStream, const int32 InRankCount, const int32 InSampleCount, TArray<int32>& OutRanks)
+{
+	OutRanks.Reset(InSampleCount);
+
+	// virtual array where every entry not in the map still holds its own rank
+	TMap<int32, int32> displacedRanks;
+	displacedRanks.Reserve(InSampleCount);
+
+	auto getRank = [&displacedRanks](const int32 InIndex) -> int32
+	{
+		const int32* displacedRank = displacedRanks.Find(InIndex);
+		return displacedRank ? *displacedRank : InIndex;
+	};
+
+	for (int32 i = 0; i < InSampleCount; ++i)
+	{
+		const int32 swapIndex = i + RandIndex(InRandStream, InRankCount - i);
+
+		// entry i is never read again, so only the swapped slot needs to remember the displaced rank
+		OutRanks.Add(getRank(swapIndex));
+		displacedRanks.Add(swapIndex, getRank(i));
+	}
+}
+
+int32 FMinesweeperMineSampler::RankToCellIndex(const int32 InRank, TConstArrayView<int32> InExcludedCellIndices)
+{
+	// find the number of excluded cells before the resulting cell index, the first excluded index where (excluded - position) > rank
+	int32 low = 0;
+	int32 high = InExcludedCellIndices.Num();
+	while (low < high)
+	{
+		const int32 middle = (low + high) / 2;
+		if (InExcludedCellIndices[middle] - middle > InRank)
+		{
+			high = middle;
+		}
+		else
+		{
+			low = middle + 1;
+		}
+	}
+
+	return InRank + low;
+}
@@ -0,0 +1,41 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperBitBoard;
+
+
+
+
+/**
+ * Picks random mine cell indices in time proportional to the mine count, without retrying collisions.
+ */
+struct FMinesweeperMineSampler
+{
+	/**
+	 * Samples InMineCount distinct cell indices from [0, InTotalCellCount) that are not in InExcludedCellIndices.
+	 * Uses a sparse partial Fisher-Yates shuffle over the candidate cells, or samples the mine free cells instead when more than half of the candidates are mines.
+	 * @param InExcludedCellIndices	Cells that must stay mine free, sorted ascending without duplicates.
+	 * @param InMineCount			Number of mines to place, clamped to the number of candidate cells.
+	 * @param OutMineCellIndices	Receives the mine cell indices in no particular order.
+	 */
+	static void SampleMines(FRandomStream& InRandStream, const int32 InTotalCellCount, TConstArrayView<int32> InExcludedCellIndices, const int32 InMineCount, TArray<int32>& OutMineCellIndices);
+
+	/**
+	 * Sets InMineCount random bits in the mine plane of an empty bit board, for boards too large to keep a list or map per mine.
+	 * Uses rejection sampling against the plane itself, clearing random bits of a full plane instead when more than half of the cells are mines,
+	 * so every mine takes at most two draws on average and no memory is needed beyond the plane.
+	 */
+	static void SampleMines(FRandomStream& InRandStream, FMinesweeperBitBoard& InOutBitBoard, const int32 InMineCount);
+
+	/** Returns a random integer in [0, InCount). Unlike FRandomStream::RandRange it keeps full precision for counts beyond 2^24. */
+	static int32 RandIndex(FRandomStream& InRandStream, const int32 InCount);
+
+private:
+	/** Draws InSampleCount distinct ranks from [0, InRankCount) with a partial Fisher-Yates shuffle that only stores displaced entries. */
+	static void SampleRanks(FRandomStream& InRandStream, const int32 InRankCount, const int32 InSampleCount, TArray<int32>& OutRanks);
+
+	/** Maps a rank among the candidate cells to its cell index by skipping the excluded cells. */
+	static int32 RankToCellIndex(const int32 InRank, TConstArrayView<int32> InExcludedCellIndices);
+};
@@ -0,0 +1,220 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperNoGuessGenerator.h"
+#include "MinesweeperMineSampler.h"
+#include "MinesweeperSolver.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/PlatformTime.h"
+#include <atomic>
+
+
+
+
+namespace MinesweeperNoGuess
+{
+	/** Number of candidates evaluated per worker between time budget checks. */
+	static const int32 CandidatesPerWorkerPerBatch = 4;
+
+
+	/**
+	 * Plays a board from the first click while only opening cells that FMinesweeperSolver proves safe from the visible state.
+	 * Proven mines are flagged so the solver can trust them on the next pass.
+	 */
+	class FCandidatePlayer
+	{
+	public:
+		FCandidatePlayer(const int32 InWidth, const int32 InHeight, TConstArrayView<bool> InMines)
+			: Width(InWidth), Height(InHeight), Mines(InMines)
+		{
+			const int32 numCells = Width * Height;
+
+			Counts.SetNumZeroed(numCells);
+
+			int32 numMines = 0;
+			for (int32 cellIndex = 0; cellIndex < numCells; ++cellIndex)
+			{
+				if (!Mines[cellIndex]) continue;
+
+				++numMines;
+				ForEachNeighbor(cellIndex, [this](const int32 InNeighborIndex) { ++Counts[InNeighborIndex]; });
+			}
+
+			NumSafeCells = numCells - numMines;
+			Board.Init(Width, Height, numMines);
+			Solver.bTreatFlagsAsMines = true;
+		}
+
+		bool Play(const int32 InFirstCellIndex)
+		{
+			if (Mines[InFirstCellIndex]) return false;
+			OpenCell(InFirstCellIndex);
+
+			while (NumOpened < NumSafeCells)
+			{
+				if (!Solver.Solve(Board, Result) || Result.SafeCellIndices.Num() == 0) return false;
+
+				for (const int32 cellIndex : Result.SafeCellIndices)
+				{
+					OpenCell(cellIndex);
+				}
+				for (const int32 cellIndex : Result.MineCellIndices)
+				{
+					Board.Cells[cellIndex] = FMinesweeperSolverBoard::FlaggedCell;
+				}
+			}
+
+			return true;
+		}
+
+	private:
+		int32 Width = 0;
+		int32 Height = 0;
+		TConstArrayView<bool> Mines;
+		TArray<uint8> Counts;
+		int32 NumSafeCells = 0;
+		int32 NumOpened = 0;
+
+		FMinesweeperSolverBoard Board;
+		FMinesweeperSolver Solver;
+		FMinesweeperSolverResult Result;
+		TArray<int32> OpenStack;
+
+
+		template<typename FuncType>
+		FORCEINLINE void ForEachNeighbor(const int32 InCellIndex, FuncType&& InFunc) const
+		{
+			const int32 cellX = InCellIndex % Width;
+			const int32 cellY = InCellIndex / Width;
+			for (int32 y = FMath::Max(cellY - 1, 0); y <= FMath::Min(cellY + 1, Height - 1); ++y)
+			{
+				for (int32 x = FMath::Max(cellX - 1, 0); x <= FMath::Min(cellX + 1, Width - 1); ++x)
+				{
+					if (x != cellX || y != cellY)
+					{
+						InFunc((y * Width) + x);
+					}
+				}
+			}
+		}
+
+		/** Reveals the cell on the visible board, flood filling through cells without neighboring mines. */
+		void OpenCell(const int32 InCellIndex)
+		{
+			if (Board.IsOpened(InCellIndex)) return;
+
+			Board.Cells[InCellIndex] = (int8)Counts[InCellIndex];
+			++NumOpened;
+
+			OpenStack.Reset();
+			if (Counts[InCellIndex] == 0)
+			{
+				OpenStack.Add(InCellIndex);
+			}
+
+			while (OpenStack.Num() > 0)
+			{
+				ForEachNeighbor(OpenStack.Pop(false), [this](const int32 InNeighborIndex)
+					{
+						if (Board.IsOpened(InNeighborIndex)) return;
+
+						Board.Cells[InNeighborIndex] = (int8)Counts[InNeighborIndex];
+						++NumOpened;
+
+						if (Counts[InNeighborIndex] == 0)
+						{
+							OpenStack.Add(InNeighborIndex);
+						}
+					});
+			}
+		}
+	};
+
+
+	/** Seed of a single candidate board, derived from the game seed so every candidate is reproducible. */
+	static int32 GetCandidateSeed(const int32 InSeed, const int32 InCandidateIndex)
+	{
+		return (int32)HashCombine(GetTypeHash(InSeed), GetTypeHash(InCandidateIndex));
+	}
+}
+
+
+
+
+bool FMinesweeperNoGuessGenerator::Generate(const FMinesweeperDifficulty& InDifficulty, const int32 InFirstCellIndex, TConstArrayView<int32> InSafeCellIndices,
+	const int32 InSeed, const float InTimeBudgetSeconds, TArray<int32>& OutMineCellIndices, FMinesweeperNoGuessStats& OutStats)
+{
+	using namespace MinesweeperNoGuess;
+
+	OutMineCellIndices.Reset();
+	OutStats = FMinesweeperNoGuessStats();
+
+	const int32 numCells = InDifficulty.TotalCells();
+	if (InFirstCellIndex < 0 || InFirstCellIndex >= numCells) return false;
+
+	const double startTime = FPlatformTime::Seconds();
+	const int32 numWorkers = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+	const int32 batchSize = numWorkers * CandidatesPerWorkerPerBatch;
+
+	OutStats.NumWorkers = numWorkers;
+
+	int32 firstBatchIndex = 0;
+	do
+	{
+		// lowest passing candidate of this batch, later candidates are skipped once one passes
+		std::atomic<int32> passingCandidateIndex(MAX_int32);
+		std::atomic<int32> numCandidatesTried(0);
+
+		ParallelFor(batchSize, [&](const int32 InBatchIndex)
+			{
+				const int32 candidateIndex = firstBatchIndex + InBatchIndex;
+				if (candidateIndex > passingCandidateIndex.load(std::memory_order_relaxed)) return;
+
+				FRandomStream randStream(GetCandidateSeed(InSeed, candidateIndex));
+				TArray<int32> mineCellIndices;
+				FMinesweeperMineSampler::SampleMines(randStream, numCells, InSafeCellIndices, InDifficulty.MineCount, mineCellIndices);
+
+				TArray<bool> mines;
+				mines.SetNumZeroed(numCells);
+				for (const int32 mineCellIndex : mineCellIndices)
+				{
+					mines[mineCellIndex] = true;
+				}
+
+				numCandidatesTried.fetch_add(1, std::memory_order_relaxed);
+
+				if (FCandidatePlayer(InDifficulty.Width, InDifficulty.Height, mines).Play(InFirstCellIndex))
+				{
+					int32 currentIndex = passingCandidateIndex.load(std::memory_order_relaxed);
+					while (candidateIndex < currentIndex && !passingCandidateIndex.compare_exchange_weak(currentIndex, candidateIndex)) { }
+				}
+			});
+
+		OutStats.CandidatesTried += numCandidatesTried.load();
+
+		const int32 passingIndex = passingCandidateIndex.load();
+		if (passingIndex != MAX_int32)
+		{
+			// regenerate the winner instead of keeping every candidate around
+			FRandomStream randStream(GetCandidateSeed(InSeed, passingIndex));
+			FMinesweeperMineSampler::SampleMines(randStream, numCells, InSafeCellIndices, InDifficulty.MineCount, OutMineCellIndices);
+
+			OutStats.bSucceeded = true;
+			break;
+		}
+
+		firstBatchIndex += batchSize;
+
+	} while (FPlatformTime::Seconds() - startTime < InTimeBudgetSeconds);
+
+	OutStats.Seconds = (float)(FPlatformTime::Seconds() - startTime);
+
+	return OutStats.bSucceeded;
+}
+
+bool FMinesweeperNoGuessGenerator::IsSolvableWithoutGuessing(const int32 InWidth, const int32 InHeight, TConstArrayView<bool> InMines, const int32 InFirstCellIndex)
+{
+	if (InWidth <= 0 || InHeight <= 0 || InMines.Num() < InWidth * InHeight || InFirstCellIndex < 0 || InFirstCellIndex >= InWidth * InHeight) return false;
+
+	return MinesweeperNoGuess::FCandidatePlayer(InWidth, InHeight, InMines).Play(InFirstCellIndex);
+}
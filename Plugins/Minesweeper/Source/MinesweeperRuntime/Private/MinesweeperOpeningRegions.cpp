@@ -0,0 +1,164 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperOpeningRegions.h"
+#include "MinesweeperCell.h"
+
+
+
+
+void FMinesweeperOpeningRegions::Build(TConstArrayView<FMinesweeperCell> InCells, const int32 InPaddedWidth)
+{
+	const int32 numCells = InCells.Num();
+
+	// union-find over the cells without neighboring mines, CellRegions holds the parent of each cell while building
+	// a parent always has a lower index than its child, so the root of a set is its first cell in scan order
+	CellRegions.SetNumUninitialized(numCells);
+
+	auto findRoot = [this](int32 InCellIndex)
+	{
+		while (CellRegions[InCellIndex] != InCellIndex)
+		{
+			CellRegions[InCellIndex] = CellRegions[CellRegions[InCellIndex]];
+			InCellIndex = CellRegions[InCellIndex];
+		}
+		return InCellIndex;
+	};
+
+	// neighbors that come earlier in scan order, the sentinel ring keeps them in bounds
+	const int32 previousNeighborOffsets[4] = { -InPaddedWidth - 1, -InPaddedWidth, -InPaddedWidth + 1, -1 };
+
+	for (int32 i = 0; i < numCells; ++i)
+	{
+		const FMinesweeperCell& cell = InCells[i];
+		if (cell.bIsSentinel || cell.bHasMine || cell.NeighborMineCount != 0)
+		{
+			CellRegions[i] = INDEX_NONE;
+			continue;
+		}
+
+		CellRegions[i] = i;
+		for (const int32 neighborOffset : previousNeighborOffsets)
+		{
+			const int32 neighborIndex = i + neighborOffset;
+			if (CellRegions[neighborIndex] == INDEX_NONE) continue;
+
+			const int32 root = findRoot(i);
+			const int32 neighborRoot = findRoot(neighborIndex);
+			if (root != neighborRoot)
+			{
+				CellRegions[FMath::Max(root, neighborRoot)] = FMath::Min(root, neighborRoot);
+			}
+		}
+	}
+
+	// number the roots in scan order, encoded below INDEX_NONE so they cannot be mistaken for parents
+	// every parent has been numbered by the time its children are reached, so one pass resolves every cell
+	int32 numRegions = 0;
+	for (int32 i = 0; i < numCells; ++i)
+	{
+		const int32 parent = CellRegions[i];
+		if (parent == INDEX_NONE) continue;
+
+		CellRegions[i] = parent == i ? -2 - numRegions++ : CellRegions[parent];
+	}
+
+	for (int32& cellRegion : CellRegions)
+	{
+		if (cellRegion != INDEX_NONE)
+		{
+			cellRegion = -2 - cellRegion;
+		}
+	}
+
+	// a numbered cell borders at most four regions, count each one once
+	auto forEachRegion = [this, InCells, InPaddedWidth](const int32 InCellIndex, auto&& InFunc)
+	{
+		const FMinesweeperCell& cell = InCells[InCellIndex];
+		if (cell.bIsSentinel || cell.bHasMine) return;
+
+		if (CellRegions[InCellIndex] != INDEX_NONE)
+		{
+			InFunc(CellRegions[InCellIndex]);
+			return;
+		}
+
+		const int32 neighborOffsets[8] = { -InPaddedWidth - 1, -InPaddedWidth, -InPaddedWidth + 1, -1, 1, InPaddedWidth - 1, InPaddedWidth, InPaddedWidth + 1 };
+
+		int32 borderRegions[8];
+		int32 numBorderRegions = 0;
+		for (const int32 neighborOffset : neighborOffsets)
+		{
+			const int32 neighborRegion = CellRegions[InCellIndex + neighborOffset];
+			if (neighborRegion == INDEX_NONE) continue;
+
+			bool bIsNewRegion = true;
+			for (int32 j = 0; j < numBorderRegions && bIsNewRegion; ++j)
+			{
+				bIsNewRegion = borderRegions[j] != neighborRegion;
+			}
+
+			if (bIsNewRegion)
+			{
+				borderRegions[numBorderRegions++] = neighborRegion;
+				InFunc(neighborRegion);
+			}
+		}
+	};
+
+	RegionStarts.Init(0, numRegions + 1);
+	for (int32 i = 0; i < numCells; ++i)
+	{
+		forEachRegion(i, [this](const int32 InRegion) { ++RegionStarts[InRegion + 1]; });
+	}
+
+	for (int32 region = 0; region < numRegions; ++region)
+	{
+		RegionStarts[region + 1] += RegionStarts[region];
+	}
+
+	// filled in scan order, so the cells of every region come out ascending
+	TArray<int32> regionCursors = RegionStarts;
+	RegionCells.SetNumUninitialized(RegionStarts[numRegions]);
+	for (int32 i = 0; i < numCells; ++i)
+	{
+		forEachRegion(i, [this, i, &regionCursors](const int32 InRegion) { RegionCells[regionCursors[InRegion]++] = i; });
+	}
+}
+
+void FMinesweeperOpeningRegions::Reset()
+{
+	CellRegions.Reset();
+	RegionStarts.Reset();
+	RegionCells.Reset();
+}
+
+
+int32 FMinesweeperOpeningRegions::OpenRegion(TArrayView<FMinesweeperCell> InCells, const int32 InRegion, TArray<int32>* OutOpenedCells) const
+{
+	if (OutOpenedCells)
+	{
+		for (const int32 cellIndex : GetRegionCells(InRegion))
+		{
+			if (!InCells[cellIndex].bIsOpened)
+			{
+				OutOpenedCells->Add(cellIndex);
+			}
+		}
+	}
+
+	int32 numOpenedCells = 0;
+	for (const int32 cellIndex : GetRegionCells(InRegion))
+	{
+		FMinesweeperCell& cell = InCells[cellIndex];
+		numOpenedCells += cell.bIsOpened ? 0 : 1;
+		cell.bIsOpened = true;
+	}
+
+	return numOpenedCells;
+}
+
+
+SIZE_T FMinesweeperOpeningRegions::GetAllocatedSize() const
+{
+	return CellRegions.GetAllocatedSize() + RegionStarts.GetAllocatedSize() + RegionCells.GetAllocatedSize();
+}
@@ -0,0 +1,718 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperSolver.h"
+#include "MinesweeperGame.h"
+#include <cmath>
+
+
+
+
+void FMinesweeperSolverBoard::Init(const int32 InWidth, const int32 InHeight, const int32 InMineCount)
+{
+	Width = FMath::Max(InWidth, 0);
+	Height = FMath::Max(InHeight, 0);
+	MineCount = InMineCount;
+
+	Cells.Init(ClosedCell, Width * Height);
+}
+
+void FMinesweeperSolverBoard::CopyFromGame(const UMinesweeperGame& InGame)
+{
+	const FMinesweeperDifficulty difficulty = InGame.GetDifficulty();
+
+	// an unbounded board has no finite grid to solve
+	if (difficulty.bUnbounded)
+	{
+		Init(0, 0, 0);
+		return;
+	}
+
+	Width = difficulty.Width;
+	Height = difficulty.Height;
+	MineCount = difficulty.MineCount;
+	Cells.SetNumUninitialized(difficulty.TotalCells());
+
+	InGame.ForEachCell([this](const FMinesweeperCell& InCell, const int32 InCellIndex, const FIntVector2& InCellCoord)
+		{
+			if (InCell.bIsOpened)
+			{
+				Cells[InCellIndex] = (int8)InCell.NeighborMineCount;
+			}
+			else
+			{
+				Cells[InCellIndex] = InCell.bIsFlagged ? FlaggedCell : ClosedCell;
+			}
+		});
+}
+
+FMinesweeperSolverBoard FMinesweeperSolverBoard::FromGame(const UMinesweeperGame& InGame)
+{
+	FMinesweeperSolverBoard board;
+	board.CopyFromGame(InGame);
+	return board;
+}
+
+
+
+
+bool FMinesweeperSolver::FConstraint::Contains(const int32 InCellIndex) const
+{
+	for (int32 i = 0; i < NumUnknownCells; ++i)
+	{
+		if (UnknownCells[i] == InCellIndex) return true;
+	}
+	return false;
+}
+
+
+template<typename FuncType>
+FORCEINLINE void FMinesweeperSolver::ForEachNeighbor(const int32 InCellIndex, FuncType&& InFunc) const
+{
+	const int32 width = Board->Width;
+	const int32 cellX = InCellIndex % width;
+	const int32 cellY = InCellIndex / width;
+	for (int32 y = FMath::Max(cellY - 1, 0); y <= FMath::Min(cellY + 1, Board->Height - 1); ++y)
+	{
+		for (int32 x = FMath::Max(cellX - 1, 0); x <= FMath::Min(cellX + 1, width - 1); ++x)
+		{
+			if (x != cellX || y != cellY)
+			{
+				InFunc((y * width) + x);
+			}
+		}
+	}
+}
+
+
+bool FMinesweeperSolver::Solve(const FMinesweeperSolverBoard& InBoard, FMinesweeperSolverResult& OutResult)
+{
+	OutResult.SafeCellIndices.Reset();
+	OutResult.MineCellIndices.Reset();
+	OutResult.bIsConsistent = false;
+
+	const bool bSolved = Prepare(InBoard) && ApplyRules();
+	Board = nullptr;
+
+	if (!bSolved) return false;
+
+	for (int32 cellIndex = 0; cellIndex < Knowledge.Num(); ++cellIndex)
+	{
+		if (Knowledge[cellIndex] == ECellKnowledge::Safe)
+		{
+			OutResult.SafeCellIndices.Add(cellIndex);
+		}
+		else if (Knowledge[cellIndex] == ECellKnowledge::Mine)
+		{
+			OutResult.MineCellIndices.Add(cellIndex);
+		}
+	}
+
+	OutResult.bIsConsistent = true;
+	return true;
+}
+
+
+bool FMinesweeperSolver::Prepare(const FMinesweeperSolverBoard& InBoard)
+{
+	if (!InBoard.IsValid()) return false;
+
+	Board = &InBoard;
+	bIsConsistent = true;
+
+	const int32 numCells = InBoard.Cells.Num();
+	Knowledge.SetNumUninitialized(numCells);
+	ConstraintIndices.Init(INDEX_NONE, numCells);
+	Constraints.Reset();
+	NumUnknownCells = 0;
+	NumRemainingMines = InBoard.MineCount;
+
+	for (int32 cellIndex = 0; cellIndex < numCells; ++cellIndex)
+	{
+		if (InBoard.IsOpened(cellIndex))
+		{
+			Knowledge[cellIndex] = ECellKnowledge::Opened;
+		}
+		else if (bTreatFlagsAsMines && InBoard.IsFlagged(cellIndex))
+		{
+			Knowledge[cellIndex] = ECellKnowledge::FlaggedMine;
+			--NumRemainingMines;
+		}
+		else
+		{
+			Knowledge[cellIndex] = ECellKnowledge::Unknown;
+			++NumUnknownCells;
+		}
+	}
+
+	return true;
+}
+
+bool FMinesweeperSolver::ApplyRules()
+{
+	// cheapest rules first, starting over with fresh constraints whenever a rule proves something
+	while (bIsConsistent)
+	{
+		BuildConstraints();
+
+		if (!bIsConsistent) break;
+		if (ApplySingleCellRules()) continue;
+		if (ApplySubsetRules()) continue;
+		if (ApplyMineCountRule()) continue;
+		if (ApplyEnumeration()) continue;
+		break;
+	}
+
+	return bIsConsistent;
+}
+
+
+bool FMinesweeperSolver::ComputeMineProbabilities(const FMinesweeperSolverBoard& InBoard, TArray<float>& OutProbabilities)
+{
+	OutProbabilities.Reset();
+
+	// proven cells are certain, which also leaves fewer and smaller components to enumerate
+	const bool bSolved = Prepare(InBoard) && ApplyRules();
+	if (!bSolved)
+	{
+		Board = nullptr;
+		return false;
+	}
+
+	// the rules stop on a pass that proved nothing, so the constraints are still current
+	BuildComponents();
+	Board = nullptr;
+
+	const int32 numComponents = ComponentStarts.Num() - 1;
+	const int32 numFrontierCells = FrontierCells.Num();
+	const int32 numOutsideCells = NumUnknownCells - numFrontierCells;
+
+	// arrangements of every component by mine count, scaled per component since only ratios matter
+	AllComponentSolutions.SetNum(numComponents);
+	AllComponentCellSolutions.SetNum(numComponents);
+	for (int32 componentIndex = 0; componentIndex < numComponents; ++componentIndex)
+	{
+		if (!EnumerateComponent(componentIndex, MaxProbabilityEnumerationSteps)) return false;
+
+		double maxSolutions = 0.0;
+		for (const double solutions : ComponentSolutions)
+		{
+			maxSolutions = FMath::Max(maxSolutions, solutions);
+		}
+		if (maxSolutions <= 0.0) return false;
+
+		for (double& solutions : ComponentSolutions) solutions /= maxSolutions;
+		for (double& solutions : ComponentCellSolutions) solutions /= maxSolutions;
+
+		AllComponentSolutions[componentIndex] = ComponentSolutions;
+		AllComponentCellSolutions[componentIndex] = ComponentCellSolutions;
+	}
+
+	// combined arrangements of the components before and after each one, so any single component can be left out
+	PrefixSolutions.SetNum(numComponents + 1);
+	SuffixSolutions.SetNum(numComponents + 1);
+	PrefixSolutions[0].Init(1.0, 1);
+	SuffixSolutions[numComponents].Init(1.0, 1);
+	for (int32 componentIndex = 0; componentIndex < numComponents; ++componentIndex)
+	{
+		Convolve(PrefixSolutions[componentIndex], AllComponentSolutions[componentIndex], PrefixSolutions[componentIndex + 1]);
+	}
+	for (int32 componentIndex = numComponents - 1; componentIndex >= 0; --componentIndex)
+	{
+		Convolve(AllComponentSolutions[componentIndex], SuffixSolutions[componentIndex + 1], SuffixSolutions[componentIndex]);
+	}
+
+	// ways to place the mines left over from S frontier mines into the cells away from the frontier, C(outside, remaining - S) in log space
+	OutsideWeights.SetNumUninitialized(numFrontierCells + 1);
+	double maxLogWeight = TNumericLimits<double>::Lowest();
+	for (int32 frontierMines = 0; frontierMines <= numFrontierCells; ++frontierMines)
+	{
+		const int32 outsideMines = NumRemainingMines - frontierMines;
+		if (outsideMines < 0 || outsideMines > numOutsideCells)
+		{
+			OutsideWeights[frontierMines] = TNumericLimits<double>::Lowest();
+			continue;
+		}
+
+		OutsideWeights[frontierMines] = std::lgamma(numOutsideCells + 1.0) - std::lgamma(outsideMines + 1.0) - std::lgamma(numOutsideCells - outsideMines + 1.0);
+		maxLogWeight = FMath::Max(maxLogWeight, OutsideWeights[frontierMines]);
+	}
+	if (maxLogWeight == TNumericLimits<double>::Lowest()) return false;
+
+	for (double& weight : OutsideWeights)
+	{
+		weight = weight == TNumericLimits<double>::Lowest() ? 0.0 : FMath::Exp(weight - maxLogWeight);
+	}
+
+	OutProbabilities.SetNumUninitialized(Knowledge.Num());
+	for (int32 cellIndex = 0; cellIndex < Knowledge.Num(); ++cellIndex)
+	{
+		const ECellKnowledge knowledge = Knowledge[cellIndex];
+		OutProbabilities[cellIndex] = (knowledge == ECellKnowledge::Mine || knowledge == ECellKnowledge::FlaggedMine) ? 1.0f : 0.0f;
+	}
+
+	for (int32 componentIndex = 0; componentIndex < numComponents; ++componentIndex)
+	{
+		Convolve(PrefixSolutions[componentIndex], SuffixSolutions[componentIndex + 1], OtherSolutions);
+
+		const TArray<double>& componentSolutions = AllComponentSolutions[componentIndex];
+		const TArray<double>& componentCellSolutions = AllComponentCellSolutions[componentIndex];
+		const int32 numMineCounts = componentSolutions.Num();
+
+		// weight of K mines in this component, summed over every arrangement of the rest of the board
+		ComponentSolutions.SetNumUninitialized(numMineCounts);
+		double totalWeight = 0.0;
+		for (int32 componentMines = 0; componentMines < numMineCounts; ++componentMines)
+		{
+			double weight = 0.0;
+			for (int32 otherMines = 0; otherMines < OtherSolutions.Num() && componentMines + otherMines <= numFrontierCells; ++otherMines)
+			{
+				weight += OtherSolutions[otherMines] * OutsideWeights[componentMines + otherMines];
+			}
+			ComponentSolutions[componentMines] = weight;
+			totalWeight += componentSolutions[componentMines] * weight;
+		}
+		if (totalWeight <= 0.0)
+		{
+			OutProbabilities.Reset();
+			return false;
+		}
+
+		// every cell of the component, numMineCounts is one more than the cell count
+		for (int32 i = 0; i < numMineCounts - 1; ++i)
+		{
+			double mineWeight = 0.0;
+			for (int32 componentMines = 0; componentMines < numMineCounts; ++componentMines)
+			{
+				mineWeight += componentCellSolutions[(i * numMineCounts) + componentMines] * ComponentSolutions[componentMines];
+			}
+
+			const int32 cellIndex = FrontierCells[ComponentFrontierCells[ComponentStarts[componentIndex] + i]].CellIndex;
+			OutProbabilities[cellIndex] = (float)(mineWeight / totalWeight);
+		}
+	}
+
+	// every cell away from the frontier is equally likely to hold one of the leftover mines
+	if (numOutsideCells > 0)
+	{
+		const TArray<double>& frontierSolutions = PrefixSolutions[numComponents];
+		double totalWeight = 0.0;
+		double outsideMineWeight = 0.0;
+		for (int32 frontierMines = 0; frontierMines < frontierSolutions.Num(); ++frontierMines)
+		{
+			const double weight = frontierSolutions[frontierMines] * OutsideWeights[frontierMines];
+			totalWeight += weight;
+			outsideMineWeight += weight * (NumRemainingMines - frontierMines);
+		}
+		if (totalWeight <= 0.0)
+		{
+			OutProbabilities.Reset();
+			return false;
+		}
+
+		const float outsideProbability = (float)(outsideMineWeight / (totalWeight * numOutsideCells));
+		for (int32 cellIndex = 0; cellIndex < Knowledge.Num(); ++cellIndex)
+		{
+			if (Knowledge[cellIndex] == ECellKnowledge::Unknown && FrontierIndices[cellIndex] == INDEX_NONE)
+			{
+				OutProbabilities[cellIndex] = outsideProbability;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+void FMinesweeperSolver::MarkCell(const int32 InCellIndex, const ECellKnowledge InKnowledge)
+{
+	const ECellKnowledge knowledge = Knowledge[InCellIndex];
+	if (knowledge == ECellKnowledge::Unknown)
+	{
+		Knowledge[InCellIndex] = InKnowledge;
+		--NumUnknownCells;
+		if (InKnowledge == ECellKnowledge::Mine) --NumRemainingMines;
+	}
+	else if (knowledge != InKnowledge && !(knowledge == ECellKnowledge::FlaggedMine && InKnowledge == ECellKnowledge::Mine))
+	{
+		// proven both ways, the visible state contradicts itself
+		bIsConsistent = false;
+	}
+}
+
+bool FMinesweeperSolver::ResolveCells(const int32* InCellIndices, const int32 InNumCells, const int32 InNumMines)
+{
+	if (InNumMines != 0 && InNumMines != InNumCells) return false;
+
+	const ECellKnowledge knowledge = InNumMines == 0 ? ECellKnowledge::Safe : ECellKnowledge::Mine;
+	for (int32 i = 0; i < InNumCells; ++i)
+	{
+		MarkCell(InCellIndices[i], knowledge);
+	}
+	return true;
+}
+
+
+void FMinesweeperSolver::BuildConstraints()
+{
+	for (const FConstraint& constraint : Constraints)
+	{
+		ConstraintIndices[constraint.CellIndex] = INDEX_NONE;
+	}
+	Constraints.Reset();
+
+	for (int32 cellIndex = 0; cellIndex < Knowledge.Num(); ++cellIndex)
+	{
+		if (Knowledge[cellIndex] != ECellKnowledge::Opened) continue;
+
+		FConstraint constraint;
+		constraint.CellIndex = cellIndex;
+		constraint.NumMines = Board->Cells[cellIndex];
+		ForEachNeighbor(cellIndex, [this, &constraint](const int32 InNeighborIndex)
+			{
+				const ECellKnowledge knowledge = Knowledge[InNeighborIndex];
+				if (knowledge == ECellKnowledge::Unknown)
+				{
+					constraint.UnknownCells[constraint.NumUnknownCells++] = InNeighborIndex;
+				}
+				else if (knowledge == ECellKnowledge::Mine || knowledge == ECellKnowledge::FlaggedMine)
+				{
+					--constraint.NumMines;
+				}
+			});
+
+		if (constraint.NumMines < 0 || constraint.NumMines > constraint.NumUnknownCells)
+		{
+			bIsConsistent = false;
+			return;
+		}
+
+		if (constraint.NumUnknownCells > 0)
+		{
+			ConstraintIndices[cellIndex] = Constraints.Add(constraint);
+		}
+	}
+}
+
+bool FMinesweeperSolver::ApplySingleCellRules()
+{
+	// constraints go stale as cells are marked, but what they state stays true so the rest can still be applied
+	bool bProgress = false;
+	for (const FConstraint& constraint : Constraints)
+	{
+		bProgress |= ResolveCells(constraint.UnknownCells, constraint.NumUnknownCells, constraint.NumMines);
+	}
+	return bProgress;
+}
+
+bool FMinesweeperSolver::ApplySubsetRules()
+{
+	const int32 width = Board->Width;
+	const int32 height = Board->Height;
+
+	for (const FConstraint& subset : Constraints)
+	{
+		const int32 cellX = subset.CellIndex % width;
+		const int32 cellY = subset.CellIndex / width;
+
+		// constraints can only share unknown cells with other constraints up to two cells away
+		for (int32 y = FMath::Max(cellY - 2, 0); y <= FMath::Min(cellY + 2, height - 1); ++y)
+		{
+			for (int32 x = FMath::Max(cellX - 2, 0); x <= FMath::Min(cellX + 2, width - 1); ++x)
+			{
+				const int32 supersetIndex = ConstraintIndices[(y * width) + x];
+				if (supersetIndex == INDEX_NONE) continue;
+
+				const FConstraint& superset = Constraints[supersetIndex];
+				if (superset.NumUnknownCells <= subset.NumUnknownCells) continue;
+
+				bool bIsSubset = true;
+				for (int32 i = 0; i < subset.NumUnknownCells && bIsSubset; ++i)
+				{
+					bIsSubset = superset.Contains(subset.UnknownCells[i]);
+				}
+				if (!bIsSubset) continue;
+
+				// the cells only in the superset hold the difference in mines
+				int32 differenceCells[8];
+				int32 numDifferenceCells = 0;
+				for (int32 i = 0; i < superset.NumUnknownCells; ++i)
+				{
+					if (!subset.Contains(superset.UnknownCells[i]))
+					{
+						differenceCells[numDifferenceCells++] = superset.UnknownCells[i];
+					}
+				}
+
+				const int32 numDifferenceMines = superset.NumMines - subset.NumMines;
+				if (numDifferenceMines < 0 || numDifferenceMines > numDifferenceCells)
+				{
+					bIsConsistent = false;
+					return false;
+				}
+
+				if (ResolveCells(differenceCells, numDifferenceCells, numDifferenceMines)) return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool FMinesweeperSolver::ApplyMineCountRule()
+{
+	if (NumRemainingMines < 0 || NumRemainingMines > NumUnknownCells)
+	{
+		bIsConsistent = false;
+		return false;
+	}
+
+	if (NumUnknownCells == 0 || (NumRemainingMines != 0 && NumRemainingMines != NumUnknownCells)) return false;
+
+	const ECellKnowledge knowledge = NumRemainingMines == 0 ? ECellKnowledge::Safe : ECellKnowledge::Mine;
+	for (int32 cellIndex = 0; cellIndex < Knowledge.Num(); ++cellIndex)
+	{
+		if (Knowledge[cellIndex] == ECellKnowledge::Unknown)
+		{
+			MarkCell(cellIndex, knowledge);
+		}
+	}
+	return true;
+}
+
+
+bool FMinesweeperSolver::ApplyEnumeration()
+{
+	if (Constraints.Num() == 0) return false;
+
+	BuildComponents();
+
+	bool bProgress = false;
+	for (int32 componentIndex = 0; componentIndex < ComponentStarts.Num() - 1; ++componentIndex)
+	{
+		const int32 numComponentCells = ComponentStarts[componentIndex + 1] - ComponentStarts[componentIndex];
+		if (numComponentCells > MaxEnumerationCells || !EnumerateComponent(componentIndex, MaxEnumerationSteps)) continue;
+
+		// only arrangements that leave a possible number of mines for the rest of the board count
+		// checked up front since marking cells below changes the unknown counts the check depends on
+		const int32 numMineCounts = numComponentCells + 1;
+		double numSolutions = 0.0;
+		for (int32 componentMines = 0; componentMines < numMineCounts; ++componentMines)
+		{
+			if (IsFeasibleMineCount(numComponentCells, componentMines))
+			{
+				numSolutions += ComponentSolutions[componentMines];
+				continue;
+			}
+
+			for (int32 i = 0; i < numComponentCells; ++i)
+			{
+				ComponentCellSolutions[(i * numMineCounts) + componentMines] = 0.0;
+			}
+		}
+
+		if (numSolutions == 0.0)
+		{
+			bIsConsistent = false;
+			return false;
+		}
+
+		for (int32 i = 0; i < numComponentCells; ++i)
+		{
+			double numMineSolutions = 0.0;
+			for (int32 componentMines = 0; componentMines < numMineCounts; ++componentMines)
+			{
+				numMineSolutions += ComponentCellSolutions[(i * numMineCounts) + componentMines];
+			}
+
+			const int32 cellIndex = FrontierCells[ComponentCells[i]].CellIndex;
+			if (numMineSolutions == 0.0)
+			{
+				MarkCell(cellIndex, ECellKnowledge::Safe);
+				bProgress = true;
+			}
+			else if (numMineSolutions == numSolutions)
+			{
+				MarkCell(cellIndex, ECellKnowledge::Mine);
+				bProgress = true;
+			}
+		}
+	}
+
+	return bProgress;
+}
+
+
+void FMinesweeperSolver::BuildComponents()
+{
+	// index the unknown cells that border opened cells
+	FrontierIndices.Init(INDEX_NONE, Knowledge.Num());
+	FrontierCells.Reset();
+	for (int32 constraintIndex = 0; constraintIndex < Constraints.Num(); ++constraintIndex)
+	{
+		const FConstraint& constraint = Constraints[constraintIndex];
+		for (int32 i = 0; i < constraint.NumUnknownCells; ++i)
+		{
+			const int32 cellIndex = constraint.UnknownCells[i];
+			if (FrontierIndices[cellIndex] == INDEX_NONE)
+			{
+				FrontierIndices[cellIndex] = FrontierCells.AddDefaulted();
+				FrontierCells[FrontierIndices[cellIndex]].CellIndex = cellIndex;
+			}
+
+			FFrontierCell& frontierCell = FrontierCells[FrontierIndices[cellIndex]];
+			frontierCell.Constraints[frontierCell.NumConstraints++] = constraintIndex;
+		}
+	}
+
+	// split the frontier into components that share no constraints, each can be enumerated on its own
+	// breadth first order keeps neighboring cells close together in the enumeration, which prunes early
+	ComponentStarts.Reset();
+	ComponentFrontierCells.Reset(FrontierCells.Num());
+	for (int32 startIndex = 0; startIndex < FrontierCells.Num(); ++startIndex)
+	{
+		if (FrontierCells[startIndex].ComponentIndex != INDEX_NONE) continue;
+
+		const int32 componentIndex = ComponentStarts.Add(ComponentFrontierCells.Num());
+		FrontierCells[startIndex].ComponentIndex = componentIndex;
+		ComponentFrontierCells.Add(startIndex);
+
+		for (int32 i = ComponentStarts[componentIndex]; i < ComponentFrontierCells.Num(); ++i)
+		{
+			const FFrontierCell& frontierCell = FrontierCells[ComponentFrontierCells[i]];
+			for (int32 c = 0; c < frontierCell.NumConstraints; ++c)
+			{
+				const FConstraint& constraint = Constraints[frontierCell.Constraints[c]];
+				for (int32 u = 0; u < constraint.NumUnknownCells; ++u)
+				{
+					const int32 frontierIndex = FrontierIndices[constraint.UnknownCells[u]];
+					if (FrontierCells[frontierIndex].ComponentIndex == INDEX_NONE)
+					{
+						FrontierCells[frontierIndex].ComponentIndex = componentIndex;
+						ComponentFrontierCells.Add(frontierIndex);
+					}
+				}
+			}
+		}
+	}
+	ComponentStarts.Add(ComponentFrontierCells.Num());
+
+	ConstraintAssignedMines.SetNumUninitialized(Constraints.Num());
+	ConstraintUnassignedCells.SetNumUninitialized(Constraints.Num());
+}
+
+bool FMinesweeperSolver::EnumerateComponent(const int32 InComponentIndex, const int32 InStepLimit)
+{
+	const int32 componentStart = ComponentStarts[InComponentIndex];
+	const int32 numComponentCells = ComponentStarts[InComponentIndex + 1] - componentStart;
+	ComponentCells = TArrayView<const int32>(ComponentFrontierCells.GetData() + componentStart, numComponentCells);
+
+	// every constraint of the component only touches cells of the component
+	for (const int32 frontierIndex : ComponentCells)
+	{
+		const FFrontierCell& frontierCell = FrontierCells[frontierIndex];
+		for (int32 c = 0; c < frontierCell.NumConstraints; ++c)
+		{
+			const int32 constraintIndex = frontierCell.Constraints[c];
+			ConstraintAssignedMines[constraintIndex] = 0;
+			ConstraintUnassignedCells[constraintIndex] = Constraints[constraintIndex].NumUnknownCells;
+		}
+	}
+
+	Assignment.SetNumZeroed(numComponentCells);
+	ComponentSolutions.Init(0.0, numComponentCells + 1);
+	ComponentCellSolutions.Init(0.0, numComponentCells * (numComponentCells + 1));
+	NumAssignedMines = 0;
+	NumEnumerationSteps = 0;
+	EnumerationStepLimit = InStepLimit;
+
+	EnumerateCell(0);
+
+	return NumEnumerationSteps <= EnumerationStepLimit;
+}
+
+void FMinesweeperSolver::EnumerateCell(const int32 InDepth)
+{
+	if (++NumEnumerationSteps > EnumerationStepLimit) return;
+
+	const int32 numComponentCells = ComponentCells.Num();
+	if (InDepth == numComponentCells)
+	{
+		ComponentSolutions[NumAssignedMines] += 1.0;
+		for (int32 i = 0; i < numComponentCells; ++i)
+		{
+			if (Assignment[i])
+			{
+				ComponentCellSolutions[(i * (numComponentCells + 1)) + NumAssignedMines] += 1.0;
+			}
+		}
+		return;
+	}
+
+	const FFrontierCell& frontierCell = FrontierCells[ComponentCells[InDepth]];
+
+	for (uint8 isMine = 0; isMine <= 1; ++isMine)
+	{
+		if (NumAssignedMines + isMine > NumRemainingMines) break;
+
+		// assign the cell, then check every constraint it touches can still be satisfied
+		bool bIsValid = true;
+		for (int32 c = 0; c < frontierCell.NumConstraints; ++c)
+		{
+			const int32 constraintIndex = frontierCell.Constraints[c];
+			ConstraintAssignedMines[constraintIndex] += isMine;
+			--ConstraintUnassignedCells[constraintIndex];
+
+			const int32 numMines = Constraints[constraintIndex].NumMines;
+			bIsValid &= ConstraintAssignedMines[constraintIndex] <= numMines && ConstraintAssignedMines[constraintIndex] + ConstraintUnassignedCells[constraintIndex] >= numMines;
+		}
+
+		if (bIsValid)
+		{
+			Assignment[InDepth] = isMine;
+			NumAssignedMines += isMine;
+			EnumerateCell(InDepth + 1);
+			NumAssignedMines -= isMine;
+		}
+
+		for (int32 c = 0; c < frontierCell.NumConstraints; ++c)
+		{
+			const int32 constraintIndex = frontierCell.Constraints[c];
+			ConstraintAssignedMines[constraintIndex] -= isMine;
+			++ConstraintUnassignedCells[constraintIndex];
+		}
+	}
+}
+
+bool FMinesweeperSolver::IsFeasibleMineCount(const int32 InComponentCells, const int32 InComponentMines) const
+{
+	// the mines left over have to fit into the unknown cells outside this component
+	const int32 numOtherUnknownCells = NumUnknownCells - InComponentCells;
+	const int32 numOtherMines = NumRemainingMines - InComponentMines;
+	return numOtherMines >= 0 && numOtherMines <= numOtherUnknownCells;
+}
+
+
+void FMinesweeperSolver::Convolve(const TArray<double>& InA, const TArray<double>& InB, TArray<double>& OutResult)
+{
+	OutResult.Init(0.0, InA.Num() + InB.Num() - 1);
+
+	double maxValue = 0.0;
+	for (int32 a = 0; a < InA.Num(); ++a)
+	{
+		if (InA[a] == 0.0) continue;
+
+		for (int32 b = 0; b < InB.Num(); ++b)
+		{
+			OutResult[a + b] += InA[a] * InB[b];
+		}
+	}
+	for (const double value : OutResult)
+	{
+		maxValue = FMath::Max(maxValue, value);
+	}
+
+	// products of many components would overflow, and a constant factor cancels out of every probability
+	if (maxValue > 0.0)
+	{
+		for (double& value : OutResult) value /= maxValue;
+	}
+}
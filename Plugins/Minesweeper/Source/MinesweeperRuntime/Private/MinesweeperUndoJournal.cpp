@@ -0,0 +1,214 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+
+#include "MinesweeperUndoJournal.h"
+#include "MinesweeperRuntimeModule.h"
+#include "MinesweeperCell.h"
+
+
+DECLARE_MEMORY_STAT(TEXT("Undo Journal"), STAT_MinesweeperUndoJournal, STATGROUP_Minesweeper);
+
+
+
+
+namespace MinesweeperUndoJournal
+{
+	/** LEB128, seven bits per byte with the high bit set on every byte but the last. */
+	static FORCEINLINE void WriteVarInt(TArray<uint8>& OutBytes, uint32 InValue)
+	{
+		while (InValue >= 0x80)
+		{
+			OutBytes.Add((uint8)(InValue | 0x80));
+			InValue >>= 7;
+		}
+		OutBytes.Add((uint8)InValue);
+	}
+
+	static FORCEINLINE uint32 ReadVarInt(const uint8*& InOutBytes)
+	{
+		uint32 value = 0;
+		for (int32 shift = 0; ; shift += 7)
+		{
+			const uint8 byte = *InOutBytes++;
+			value |= (uint32)(byte & 0x7F) << shift;
+			if (byte < 0x80) return value;
+		}
+	}
+}
+
+
+
+
+void FMinesweeperUndoJournal::Reset()
+{
+	Entries.Reset();
+	Bytes.Reset();
+	NumAppliedEntries = 0;
+
+	SET_MEMORY_STAT(STAT_MinesweeperUndoJournal, 0);
+}
+
+void FMinesweeperUndoJournal::SetMaxBytes(const int64 InMaxBytes)
+{
+	MaxBytes = FMath::Max<int64>(InMaxBytes, 0);
+
+	if (!IsEnabled())
+	{
+		Reset();
+	}
+	else if (GetUsedBytes() > MaxBytes)
+	{
+		DropOldestEntries();
+	}
+}
+
+
+void FMinesweeperUndoJournal::Record(TArray<int32>& InOutCellIndices, const FEntry& InEntry)
+{
+	if (!IsEnabled() || InOutCellIndices.Num() == 0) return;
+
+	// a new action makes the undone entries unreachable
+	if (NumRedoEntries() > 0)
+	{
+		Bytes.SetNum(NumAppliedEntries > 0 ? Entries[NumAppliedEntries - 1].FirstByte + Entries[NumAppliedEntries - 1].NumBytes : 0, false);
+		Entries.SetNum(NumAppliedEntries, false);
+	}
+
+	InOutCellIndices.Sort();
+
+	FEntry& entry = Entries.Add_GetRef(InEntry);
+	entry.FirstByte = Bytes.Num();
+	entry.NumCells = InOutCellIndices.Num();
+
+	// each run of consecutive indices is stored as its gap from the end of the previous run and its length
+	// rows of a flood fill come out as one run each, so even huge openings take a few bytes per row
+	int32 runEnd = 0;
+	for (int32 i = 0; i < InOutCellIndices.Num(); )
+	{
+		const int32 runStart = InOutCellIndices[i];
+		int32 runLength = 1;
+		while (i + runLength < InOutCellIndices.Num() && InOutCellIndices[i + runLength] == runStart + runLength)
+		{
+			++runLength;
+		}
+
+		MinesweeperUndoJournal::WriteVarInt(Bytes, (uint32)(runStart - runEnd));
+		MinesweeperUndoJournal::WriteVarInt(Bytes, (uint32)runLength);
+
+		runEnd = runStart + runLength;
+		i += runLength;
+	}
+
+	entry.NumBytes = Bytes.Num() - entry.FirstByte;
+	NumAppliedEntries = Entries.Num();
+
+	if (GetUsedBytes() > MaxBytes)
+	{
+		DropOldestEntries();
+	}
+
+	SET_MEMORY_STAT(STAT_MinesweeperUndoJournal, GetAllocatedSize());
+}
+
+
+const FMinesweeperUndoJournal::FEntry* FMinesweeperUndoJournal::Undo(TArrayView<FMinesweeperCell> InOutCells, TArray<int32>* OutCellIndices)
+{
+	if (NumUndoEntries() == 0) return nullptr;
+
+	const FEntry& entry = Entries[--NumAppliedEntries];
+	FlipCells(entry, InOutCells, OutCellIndices);
+
+	return &entry;
+}
+
+const FMinesweeperUndoJournal::FEntry* FMinesweeperUndoJournal::Redo(TArrayView<FMinesweeperCell> InOutCells, TArray<int32>* OutCellIndices)
+{
+	if (NumRedoEntries() == 0) return nullptr;
+
+	const FEntry& entry = Entries[NumAppliedEntries++];
+	FlipCells(entry, InOutCells, OutCellIndices);
+
+	return &entry;
+}
+
+
+void FMinesweeperUndoJournal::FlipCells(const FEntry& InEntry, TArrayView<FMinesweeperCell> InOutCells, TArray<int32>* OutCellIndices) const
+{
+	if (OutCellIndices)
+	{
+		OutCellIndices->Reserve(OutCellIndices->Num() + InEntry.NumCells);
+	}
+
+	const uint8* bytes = Bytes.GetData() + InEntry.FirstByte;
+	const uint8* bytesEnd = bytes + InEntry.NumBytes;
+
+	int32 runEnd = 0;
+	while (bytes < bytesEnd)
+	{
+		const int32 runStart = runEnd + (int32)MinesweeperUndoJournal::ReadVarInt(bytes);
+		runEnd = runStart + (int32)MinesweeperUndoJournal::ReadVarInt(bytes);
+
+		if (OutCellIndices)
+		{
+			for (int32 i = runStart; i < runEnd; ++i)
+			{
+				OutCellIndices->Add(i);
+			}
+		}
+
+		if (InEntry.ChangedBit == ECellBit::Opened)
+		{
+			for (int32 i = runStart; i < runEnd; ++i)
+			{
+				InOutCells[i].bIsOpened = !InOutCells[i].bIsOpened;
+			}
+		}
+		else
+		{
+			for (int32 i = runStart; i < runEnd; ++i)
+			{
+				InOutCells[i].bIsFlagged = !InOutCells[i].bIsFlagged;
+			}
+		}
+	}
+}
+
+void FMinesweeperUndoJournal::DropOldestEntries()
+{
+	const int64 targetBytes = MaxBytes - (MaxBytes / 4);
+
+	int32 numDroppedEntries = 0;
+	int32 numDroppedBytes = 0;
+	for (int64 usedBytes = GetUsedBytes(); usedBytes > targetBytes && numDroppedEntries < Entries.Num(); ++numDroppedEntries)
+	{
+		usedBytes -= Entries[numDroppedEntries].NumBytes + sizeof(FEntry);
+		numDroppedBytes += Entries[numDroppedEntries].NumBytes;
+	}
+
+	if (numDroppedEntries == 0) return;
+
+	// undone entries can only be redone in order, so once one of them goes they all go
+	if (numDroppedEntries > NumAppliedEntries)
+	{
+		numDroppedEntries = Entries.Num();
+		numDroppedBytes = Bytes.Num();
+	}
+
+	UE_LOG(LogMinesweeperRuntime, Verbose, TEXT("Undo journal over its %lld byte cap, dropped the %d oldest entries"), MaxBytes, numDroppedEntries);
+
+	Entries.RemoveAt(0, numDroppedEntries, false);
+	Bytes.RemoveAt(0, numDroppedBytes, false);
+	NumAppliedEntries -= FMath::Min(numDroppedEntries, NumAppliedEntries);
+
+	for (FEntry& entry : Entries)
+	{
+		entry.FirstByte -= numDroppedBytes;
+	}
+
+	SET_MEMORY_STAT(STAT_MinesweeperUndoJournal, GetAllocatedSize());
+}
+
+
+SIZE_T FMinesweeperUndoJournal::GetAllocatedSize() const
+{
+	return Entries.GetAllocatedSize() + Bytes.GetAllocatedSize();
+}
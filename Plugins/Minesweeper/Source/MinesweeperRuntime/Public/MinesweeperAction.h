@@ -0,0 +1,51 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MinesweeperAction.generated.h"
+
+
+
+
+UENUM(BlueprintType)
+enum class EMinesweeperActionType : uint8
+{
+	/** UMinesweeperGame::TryOpenCellAt */
+	Open,
+
+	/** UMinesweeperGame::TryFlagCellAt */
+	Flag,
+
+	/** UMinesweeperGame::TryChordCellAt */
+	Chord
+};
+
+
+/**
+ * A single player move, queued up for UMinesweeperGame::ApplyActions by bots, replays and scripted tests.
+ */
+USTRUCT(BlueprintType)
+struct MINESWEEPERRUNTIME_API FMinesweeperAction
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperAction")
+		EMinesweeperActionType Type = EMinesweeperActionType::Open;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperAction")
+		int64 CellX = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperAction")
+		int64 CellY = 0;
+
+
+	FMinesweeperAction() { }
+
+	FMinesweeperAction(const EMinesweeperActionType InType, const int64 InCellX, const int64 InCellY)
+		: Type(InType), CellX(InCellX), CellY(InCellY)
+	{ }
+
+	static FMinesweeperAction Open(const int64 InCellX, const int64 InCellY) { return FMinesweeperAction(EMinesweeperActionType::Open, InCellX, InCellY); }
+	static FMinesweeperAction Flag(const int64 InCellX, const int64 InCellY) { return FMinesweeperAction(EMinesweeperActionType::Flag, InCellX, InCellY); }
+	static FMinesweeperAction Chord(const int64 InCellX, const int64 InCellY) { return FMinesweeperAction(EMinesweeperActionType::Chord, InCellX, InCellY); }
+};
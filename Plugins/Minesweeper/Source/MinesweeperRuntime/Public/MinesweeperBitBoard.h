@@ -0,0 +1,68 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperCell;
+
+
+
+
+/**
+ * Bitplane representation of the mines of a Minesweeper grid. The plane stores one bit per cell, packed row by row into 64-bit words.
+ * Bits past the grid width in the last word of each row are always zero.
+ */
+struct MINESWEEPERRUNTIME_API FMinesweeperBitBoard
+{
+	/** Width of the grid in cells. */
+	int32 Width = 0;
+
+	/** Height of the grid in cells. */
+	int32 Height = 0;
+
+	/** Number of 64-bit words used to store a single row of a plane. */
+	int32 WordsPerRow = 0;
+
+	/** One bit per cell that contains a mine. */
+	TArray<uint64> MinePlane;
+
+
+	FMinesweeperBitBoard() { }
+	FMinesweeperBitBoard(const int32 InWidth, const int32 InHeight) { Init(InWidth, InHeight); }
+
+
+	/** Resizes the mine plane to the given grid size and clears every bit. */
+	void Init(const int32 InWidth, const int32 InHeight);
+
+	/** Clears every bit of the mine plane. */
+	void Reset();
+
+
+	FORCEINLINE int32 WordIndex(const int32 InX, const int32 InY) const { return (InY * WordsPerRow) + (InX >> 6); }
+	FORCEINLINE static uint64 BitMask(const int32 InX) { return 1ull << (InX & 63); }
+
+	FORCEINLINE static bool GetBit(const TArray<uint64>& InPlane, const int32 InWordIndex, const uint64 InBitMask) { return (InPlane[InWordIndex] & InBitMask) != 0; }
+	FORCEINLINE static void SetBit(TArray<uint64>& InPlane, const int32 InWordIndex, const uint64 InBitMask) { InPlane[InWordIndex] |= InBitMask; }
+
+	FORCEINLINE bool HasMine(const int32 InX, const int32 InY) const { return GetBit(MinePlane, WordIndex(InX, InY), BitMask(InX)); }
+
+	FORCEINLINE void SetMine(const int32 InX, const int32 InY) { SetBit(MinePlane, WordIndex(InX, InY), BitMask(InX)); }
+
+
+	/**
+	 * Computes the number of neighboring mines for every cell with bit-sliced adds of the eight shifted mine planes.
+	 * Large boards are split into bands of rows that are counted in parallel.
+	 * OutNeighborMineCounts must hold Width * Height entries and is written row major.
+	 */
+	void ComputeNeighborMineCounts(TArrayView<uint8> OutNeighborMineCounts) const;
+
+	/**
+	 * Same as above but writes straight into the NeighborMineCount of a cell array.
+	 * Row Y of the grid starts at InFirstCellIndex + (Y * InRowStride), a row stride of 0 means rows are Width cells apart.
+	 */
+	void ComputeNeighborMineCounts(TArrayView<FMinesweeperCell> OutCells, const int32 InFirstCellIndex = 0, const int32 InRowStride = 0) const;
+
+	/** Returns the name of the vector instruction set the neighbor count kernel was compiled with. */
+	static const TCHAR* GetKernelName();
+
+};
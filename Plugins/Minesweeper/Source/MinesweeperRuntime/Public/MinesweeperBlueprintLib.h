@@ -4,6 +4,7 @@
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "MinesweeperDifficulty.h"
+#include "MinesweeperSolver.h"
 #include "MinesweeperBlueprintLib.generated.h"
 
 class UMinesweeperGridCanvas;
@@ -44,5 +45,14 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Minesweeper")
 		static bool IsExpertDifficulty(const FMinesweeperDifficulty& Difficulty);
 
+
+	/** Proves which closed cells of the game are safe or mines using only what the player can see. */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		static FMinesweeperSolverResult SolveMinesweeperGame(const UMinesweeperGame* Game, const bool bTreatFlagsAsMines = false);
+
+	/** Returns the exact mine probability of every cell, indexed like UMinesweeperGame::GridCoordToIndex. Empty if it could not be computed. */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		static TArray<float> GetMineProbabilities(const UMinesweeperGame* Game, const bool bTreatFlagsAsMines = false);
+
 };
 
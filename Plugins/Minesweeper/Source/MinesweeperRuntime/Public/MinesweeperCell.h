@@ -0,0 +1,48 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+
+
+
+
+/**
+ * Data representation for a single grid cell. Packed into a single byte so the whole grid can be stored in one flat array.
+ */
+struct FMinesweeperCell
+{
+	/** NeighborMineCount of a cell whose count has not been computed yet, see FMinesweeperDifficulty::bLazyNeighborCounts. */
+	static constexpr uint8 UnknownNeighborMineCount = 0xF;
+
+	/** Holds the number of mines that surround this cell (0-8), or UnknownNeighborMineCount. */
+	uint8 NeighborMineCount : 4;
+
+	/** True if this cell contains a mine. */
+	uint8 bHasMine : 1;
+
+	/** True if this cell has been left clicked and is open. */
+	uint8 bIsOpened : 1;
+
+	/** True if the user has marked this cell with a flag. */
+	uint8 bIsFlagged : 1;
+
+	/** True if this cell is part of the padding ring around the grid and not a playable cell. */
+	uint8 bIsSentinel : 1;
+
+	FMinesweeperCell() 
+		: NeighborMineCount(0), bHasMine(false), bIsOpened(false), bIsFlagged(false), bIsSentinel(false)
+	{ }
+
+	FORCEINLINE bool HasKnownNeighborMineCount() const { return NeighborMineCount != UnknownNeighborMineCount; }
+
+	void Reset()
+	{
+		NeighborMineCount = 0;
+		bHasMine = false;
+		bIsOpened = false;
+		bIsFlagged = false;
+		bIsSentinel = false;
+	}
+};
+
+static_assert(sizeof(FMinesweeperCell) == 1, "FMinesweeperCell must stay packed into a single byte.");
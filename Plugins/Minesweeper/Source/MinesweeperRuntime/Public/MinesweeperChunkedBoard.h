@@ -0,0 +1,221 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "MinesweeperCell.h"
+#include "MinesweeperChunkedBoard.generated.h"
+
+class FMinesweeperChunkPageFile;
+
+
+
+
+/**
+ * Memory use of an unbounded board, see FMinesweeperChunkedBoard::GetStats.
+ */
+USTRUCT(BlueprintType)
+struct MINESWEEPERRUNTIME_API FMinesweeperChunkStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Chunks currently held in memory. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperChunkStats")
+		int32 NumResidentChunks = 0;
+
+	/** Chunks whose opened and flagged cells were written to the page file and dropped from memory. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperChunkStats")
+		int32 NumPagedOutChunks = 0;
+
+	/** Paged out chunks being read back in the background. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperChunkStats")
+		int32 NumPendingPageIns = 0;
+
+	/** Chunks that had to be read back from disk while game logic waited on them. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperChunkStats")
+		int32 NumBlockingPageIns = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperChunkStats")
+		int64 ResidentBytes = 0;
+
+	/** Memory ceiling of resident chunks, 0 if chunks are never paged out. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperChunkStats")
+		int64 MaxResidentBytes = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperChunkStats")
+		int64 PageFileBytes = 0;
+};
+
+
+
+
+/**
+ * Unbounded Minesweeper board stored as square chunks of cells that are only created when a flood fill or a lookup first touches them.
+ * Every mine is derived from a hash of the seed, the chunk coordinate and the cell within the chunk, so chunks can be created in any order
+ * and memory grows with the explored area instead of the size of the board.
+ * Past MaxResidentChunks the least recently used chunks are paged out: chunks the player never changed are simply dropped and regenerated
+ * from the hash, the others keep only their opened and flagged bits in a page file under Saved/Minesweeper and are read back when touched.
+ */
+struct MINESWEEPERRUNTIME_API FMinesweeperChunkedBoard
+{
+	static constexpr int32 ChunkShift = 6;
+	static constexpr int32 ChunkSize = 1 << ChunkShift; // 64x64 cells per chunk
+	static constexpr int32 ChunkMask = ChunkSize - 1;
+	static constexpr int32 CellsPerChunk = ChunkSize * ChunkSize;
+
+	/** Cell coordinates are valid from -MaxCellCoord to MaxCellCoord - 1 on both axes, so chunk coordinates fit in 32 bits. */
+	static constexpr int64 MaxCellCoord = (int64)MAX_int32 << ChunkShift;
+
+	/**
+	 * Lowest supported mine density. Below roughly 0.1 the cells without neighboring mines connect into one infinite region,
+	 * so a single click would flood fill forever.
+	 */
+	static constexpr float MinMineDensity = 0.1f;
+	static constexpr float MaxMineDensity = 0.9f;
+
+
+	/** Bytes a paged out chunk takes in the page file, one opened and one flagged bit per cell. */
+	static constexpr int32 PageSize = (CellsPerChunk / 8) * 2;
+
+
+	/** Cells of one chunk, row major. */
+	struct FChunk
+	{
+		FMinesweeperCell Cells[CellsPerChunk];
+
+		/** Value of the board touch clock when GetCell last switched to this chunk, the lowest is evicted first. */
+		uint64 LastTouch = 0;
+	};
+
+
+	FMinesweeperChunkedBoard();
+	~FMinesweeperChunkedBoard();
+
+	FMinesweeperChunkedBoard(const FMinesweeperChunkedBoard&) = delete;
+	FMinesweeperChunkedBoard& operator=(const FMinesweeperChunkedBoard&) = delete;
+
+
+	/** Drops every chunk and starts a new board. */
+	void Init(const int32 InSeed, const float InMineDensity);
+
+	/** Drops every chunk, paged out or not, and the safe zone. The board keeps its seed so the same mines come back. */
+	void Reset();
+
+	/** Sets how many chunks stay in memory before TrimResidentChunks pages out the least recently used ones. 0 or less keeps every chunk. */
+	void SetMaxResidentChunks(const int32 InMaxResidentChunks);
+	FORCEINLINE int32 GetMaxResidentChunks() const { return MaxResidentChunks; }
+
+
+	/** Keeps the square of cells around the center free of mines and recomputes every created cell it affects. */
+	void SetSafeZone(const int64 InCenterX, const int64 InCenterY, const int32 InRadius);
+
+	/** Returns true if the cell holds a mine. Does not create any chunk. */
+	bool HasMine(const int64 InCellX, const int64 InCellY) const;
+
+
+	static bool IsValidCellCoord(const int64 InCellX, const int64 InCellY);
+
+	/** Returns the cell, creating its chunk or reading it back from the page file if needed. The cell coordinate must be valid. */
+	FMinesweeperCell& GetCell(const int64 InCellX, const int64 InCellY);
+
+	/** Like GetCell, but returns nullptr instead of waiting for a paged out chunk, which starts being read back in the background. */
+	FMinesweeperCell* TryGetCell(const int64 InCellX, const int64 InCellY);
+
+	/** Returns the cell or nullptr if its chunk is not resident. */
+	const FMinesweeperCell* FindCell(const int64 InCellX, const int64 InCellY) const;
+
+	/** Opens the cell and flood fills outward through cells without neighboring mines, creating chunks as it goes. Returns the number of cells opened. */
+	int32 OpenCell(const int64 InCellX, const int64 InCellY);
+
+
+	/**
+	 * Pages out the least recently used chunks until at most MaxResidentChunks are resident. Called between game actions and after the grid canvas
+	 * drew the view, a single flood fill may go over the limit and cells returned by GetCell must not be kept across this call.
+	 */
+	void TrimResidentChunks();
+
+	/** Installs chunks whose background reads finished and starts reading the paged out chunks overlapping the cell rect, bounds inclusive. */
+	void PrefetchChunks(const int64 InMinCellX, const int64 InMinCellY, const int64 InMaxCellX, const int64 InMaxCellY);
+
+	/** Installs chunks whose background reads finished. Returns the number of chunks installed. */
+	int32 InstallFinishedPageIns();
+
+	FORCEINLINE bool HasPendingPageIns() const { return PendingPageIns.Num() > 0; }
+
+
+	/** Returns the number of resident chunks. */
+	FORCEINLINE int32 GetNumChunks() const { return Chunks.Num(); }
+
+	/** Returns the number of bytes held by resident chunks and bookkeeping. */
+	SIZE_T GetAllocatedSize() const;
+
+	FMinesweeperChunkStats GetStats() const;
+
+
+	FORCEINLINE static FIntPoint CellToChunkCoord(const int64 InCellX, const int64 InCellY) { return FIntPoint((int32)(InCellX >> ChunkShift), (int32)(InCellY >> ChunkShift)); }
+	FORCEINLINE static int32 CellToLocalIndex(const int64 InCellX, const int64 InCellY) { return ((int32)(InCellY & ChunkMask) << ChunkShift) + (int32)(InCellX & ChunkMask); }
+
+
+private:
+	struct FCellCoord
+	{
+		int64 X;
+		int64 Y;
+	};
+
+	int32 Seed = 0;
+
+	/** A cell holds a mine when its hash is below this threshold. */
+	uint64 MineHashThreshold = 0;
+
+	bool bHasSafeZone = false;
+	int64 SafeZoneCenterX = 0;
+	int64 SafeZoneCenterY = 0;
+	int32 SafeZoneRadius = 0;
+
+	TMap<FIntPoint, TUniquePtr<FChunk>> Chunks;
+
+	/** Last chunk returned by GetCell, flood fills mostly stay within one chunk. */
+	FIntPoint CachedChunkCoord = FIntPoint(MAX_int32, MAX_int32);
+	FChunk* CachedChunk = nullptr;
+
+	int32 MaxResidentChunks = 0;
+	uint64 TouchClock = 0;
+
+	/** Created on the first page out. Shared with background reads so it outlives a board destroyed while they run. */
+	TSharedPtr<FMinesweeperChunkPageFile, ESPMode::ThreadSafe> PageFile;
+
+	/** Page file slot of every paged out chunk. Chunks keep their slot while resident so paging out again rewrites it in place. */
+	TMap<FIntPoint, int32> PageSlots;
+	TArray<int32> FreePageSlots;
+	int32 NumPageSlots = 0;
+
+	TMap<FIntPoint, TFuture<TArray<uint8>>> PendingPageIns;
+	int32 NumBlockingPageIns = 0;
+
+	/** Explicit stack of cells used by OpenCell, kept between calls to avoid reallocating. */
+	TArray<FCellCoord> FloodFillStack;
+
+
+	FChunk& FindOrCreateChunk(const FIntPoint& InChunkCoord);
+
+	/** Fills the mines and neighbor mine counts of a chunk from the hash. */
+	void GenerateChunk(const FIntPoint& InChunkCoord, FChunk& OutChunk) const;
+
+	/** Creates a resident chunk from the hash and the page read back for it. */
+	FChunk& InstallPagedInChunk(const FIntPoint& InChunkCoord, const TArray<uint8>& InPage);
+
+	bool IsPagedOut(const FIntPoint& InChunkCoord) const { return PageSlots.Contains(InChunkCoord) && !Chunks.Contains(InChunkCoord); }
+	void StartPageIn(const FIntPoint& InChunkCoord);
+	void PageOutChunk(const FIntPoint& InChunkCoord);
+
+	/** Waits for every background read, their results are dropped. */
+	void CancelPageIns();
+
+	/** Recomputes the mine and neighbor mine count of a created cell from the hash and the safe zone. */
+	void RecomputeCell(FMinesweeperCell& OutCell, const int64 InCellX, const int64 InCellY) const;
+
+	bool IsInSafeZone(const int64 InCellX, const int64 InCellY) const;
+
+	static uint64 HashCell(const int32 InSeed, const FIntPoint& InChunkCoord, const int32 InLocalIndex);
+};
@@ -16,23 +16,54 @@ struct MINESWEEPERRUNTIME_API FMinesweeperDifficulty
 	GENERATED_USTRUCT_BODY()
 
 	/** Width of the Minesweeper grid in cells. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty", Meta = (UIMin = 1, ClampMin = 1, UIMax = 64, ClampMax = 64))
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty", Meta = (UIMin = 1, ClampMin = 1, UIMax = 64, ClampMax = 10000))
 		int32 Width = 1;
 
 	/** Height of the Minesweeper grid in cells. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty", Meta = (UIMin = 1, ClampMin = 1, UIMax = 64, ClampMax = 64))
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty", Meta = (UIMin = 1, ClampMin = 1, UIMax = 64, ClampMax = 10000))
 		int32 Height = 1;
 
 	/** Mine count of the Minesweeper grid. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty", Meta = (UIMin = 1, ClampMin = 1, UIMax = 500, ClampMax = 500))
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty", Meta = (UIMin = 1, ClampMin = 1, UIMax = 500, ClampMax = 100000000))
 		int32 MineCount = 1;
 
+	/** Size of the square around the first clicked cell that is kept free of mines. 1 only protects the clicked cell, 3 protects its 3x3 neighborhood. Even sizes round down to the next odd size. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty", Meta = (UIMin = 1, ClampMin = 1, UIMax = 9, ClampMax = 9))
+		int32 SafeZoneSize = 1;
+
+	/** Only generate boards that can be solved from the first click without guessing. Forces a safe zone of at least 3x3. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty")
+		bool bNoGuess = false;
+
+	/**
+	 * Allows grids up to UMinesweeperGame::MaxLargeGridSize cells wide and tall. Mines are placed when the game is set up and moved out of the safe zone
+	 * on the first click, so the first click only costs as much as the area it opens. No-guess generation is not available on large boards.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty")
+		bool bLargeBoard = false;
+
+	/**
+	 * Compute the neighbor mine count of a cell when it is opened instead of for the whole board once mines are placed,
+	 * so the cost follows the opened area instead of the board area. Always on for large boards.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty")
+		bool bLazyNeighborCounts = false;
+
+	/**
+	 * Infinite board whose mines are generated on demand as it is explored. Width and Height only size the visible window,
+	 * the board keeps the mine density of MineCount mines on a Width x Height grid, clamped to FMinesweeperChunkedBoard::MinMineDensity.
+	 * An unbounded game can only be lost.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MinesweeperDifficulty")
+		bool bUnbounded = false;
+
 
 	FMinesweeperDifficulty() { }
 	FMinesweeperDifficulty(const int32 InWidth, const int32 InHeight, const int32 InMineCount)
 		: Width(InWidth), Height(InHeight), MineCount(InMineCount) { }
 
 
+	/** The safe zone, no-guess, large-board, lazy count and unbounded modes only change how mines are generated, not the difficulty preset or its high scores. */
 	bool operator == (const FMinesweeperDifficulty& InOther) const
 	{
 		return (Width == InOther.Width && Height == InOther.Height && MineCount == InOther.MineCount);
@@ -48,11 +79,19 @@ struct MINESWEEPERRUNTIME_API FMinesweeperDifficulty
 		Width = InOther.Width;
 		Height = InOther.Height;
 		MineCount = InOther.MineCount;
+		SafeZoneSize = InOther.SafeZoneSize;
+		bNoGuess = InOther.bNoGuess;
+		bLargeBoard = InOther.bLargeBoard;
+		bLazyNeighborCounts = InOther.bLazyNeighborCounts;
+		bUnbounded = InOther.bUnbounded;
 	}
 
 
 	FIntVector2 GridSize() const { return FIntVector2(Width, Height); }
 	int32 TotalCells() const { return Width * Height; }
+	float MineDensity() const { return TotalCells() > 0 ? (float)MineCount / TotalCells() : 0.0f; }
+	bool UsesLazyNeighborCounts() const { return bLazyNeighborCounts || bLargeBoard; }
+	int32 SafeZoneRadius() const { return FMath::Max((FMath::Max(SafeZoneSize, 1) - 1) / 2, bNoGuess ? 1 : 0); }
 
 	bool IsBeginner() const { return *this == Beginner(); }
 	bool IsIntermediate() const { return *this == Intermediate(); }
@@ -4,42 +4,78 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "MinesweeperDifficulty.h"
+#include "MinesweeperCell.h"
+#include "MinesweeperAction.h"
+#include "MinesweeperChunkedBoard.h"
+#include "MinesweeperOpeningRegions.h"
+#include "MinesweeperUndoJournal.h"
+#include "MinesweeperGameSnapshot.h"
+#include "MinesweeperNoGuessGenerator.h"
 #include "MinesweeperGame.generated.h"
 
 
 
 
 /**
- * Data representation for a single grid cell.
+ * Range over the playable cells of a padded cell array (see UMinesweeperGame::GetCells), skipping the sentinel ring.
+ * Iterating yields the cell together with its grid index and coordinate, without allocating.
  */
-USTRUCT()
-struct MINESWEEPERRUNTIME_API FMinesweeperCell
+template<typename CellType>
+class TMinesweeperCellRange
 {
-	GENERATED_USTRUCT_BODY()
-
-	/** Holds the number of mines that surround this cell. */
-	UPROPERTY() int32 NeighborMineCount;
-
-	/** True if this cell contains a mine. */
-	UPROPERTY() uint8 bHasMine : 1;
-
-	/** True if this cell has been left clicked and is open. */
-	UPROPERTY() uint8 bIsOpened : 1;
-
-	/** True if the user has marked this cell with a flag. */
-	UPROPERTY() uint8 bIsFlagged : 1;
+public:
+	struct FElement
+	{
+		CellType& Cell;
+		int32 Index;
+		FIntVector2 Coord;
+	};
 
-	FMinesweeperCell() 
-		: NeighborMineCount(-1), bHasMine(false), bIsOpened(false), bIsFlagged(false)
+	class FIterator
+	{
+	public:
+		FIterator(CellType* InCells, const int32 InWidth, const int32 InIndex)
+			: Cells(InCells), Width(InWidth), Index(InIndex), PaddedIndex(InWidth + 3), X(0), Y(0)
+		{ }
+
+		FORCEINLINE FElement operator*() const { return FElement{ Cells[PaddedIndex], Index, FIntVector2(X, Y) }; }
+
+		FORCEINLINE FIterator& operator++()
+		{
+			++Index;
+			++PaddedIndex;
+			if (++X == Width)
+			{
+				// step over the right sentinel of this row and the left sentinel of the next
+				X = 0;
+				++Y;
+				PaddedIndex += 2;
+			}
+			return *this;
+		}
+
+		FORCEINLINE bool operator!=(const FIterator& InOther) const { return Index != InOther.Index; }
+
+	private:
+		CellType* Cells;
+		int32 Width;
+		int32 Index;
+		int32 PaddedIndex;
+		int32 X;
+		int32 Y;
+	};
+
+	TMinesweeperCellRange(CellType* InCells, const int32 InWidth, const int32 InHeight)
+		: Cells(InCells), Width(InWidth), NumCells(InCells ? InWidth * InHeight : 0)
 	{ }
 
-	void Reset()
-	{
-		NeighborMineCount = -1;
-		bHasMine = false;
-		bIsOpened = false;
-		bIsFlagged = false;
-	}
+	FORCEINLINE FIterator begin() const { return FIterator(Cells, Width, 0); }
+	FORCEINLINE FIterator end() const { return FIterator(Cells, Width, NumCells); }
+
+private:
+	CellType* Cells;
+	int32 Width;
+	int32 NumCells;
 };
 
 
@@ -48,6 +84,8 @@ struct MINESWEEPERRUNTIME_API FMinesweeperCell
 DECLARE_MULTICAST_DELEGATE_ThreeParams(FMinesweeperGameOverDelegated, const bool, const float, const int32);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FMinesweeperGameOverDelegate, const bool, Won, const float, Time, const int32, Clicks);
 
+DECLARE_MULTICAST_DELEGATE(FMinesweeperBoardChangedDelegate);
+
 
 /**
  * Minesweeper game logic.
@@ -64,6 +102,8 @@ public:
 	static const int32 MinMineCount = 1;
 	static const int32 MaxMineCount = 400;
 
+	static const int32 MaxLargeGridSize = 10000; // 100M cells max, see FMinesweeperDifficulty::bLargeBoard
+
 
 	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
 		void SetupGame(const FMinesweeperDifficulty& InDifficulty);
@@ -72,7 +112,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
 		void RestartGame();
 
-	/** Returns false if the cell coordinate is invalid or the cell is open. */
+	/** Returns false if the cell coordinate is invalid, the cell is open or flagged, or the game is over. */
 	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
 		bool TryOpenCell(const int32 CellX, const int32 CellY);
 
@@ -80,6 +120,78 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
 		bool TryFlagCell(const int32 CellX, const int32 CellY);
 
+	/**
+	 * Opens every closed, unflagged neighbor of an opened cell once as many neighbors are flagged as it has neighboring mines.
+	 * The neighbors are revealed as a single action with one game over check. Returns false if the flags do not match or nothing was opened.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		bool TryChordCell(const int32 CellX, const int32 CellY);
+
+	/** TryOpenCell with 64-bit coordinates, which unbounded boards accept anywhere within FMinesweeperChunkedBoard::MaxCellCoord. */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		bool TryOpenCellAt(const int64 CellX, const int64 CellY);
+
+	/** TryFlagCell with 64-bit coordinates, which unbounded boards accept anywhere within FMinesweeperChunkedBoard::MaxCellCoord. */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		bool TryFlagCellAt(const int64 CellX, const int64 CellY);
+
+	/** TryChordCell with 64-bit coordinates, which unbounded boards accept anywhere within FMinesweeperChunkedBoard::MaxCellCoord. */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		bool TryChordCellAt(const int64 CellX, const int64 CellY);
+
+
+	/**
+	 * Applies the actions in order, stopping once the game is over. OutResults receives what each action returned, false for actions after the end.
+	 * OnBoardChanged and OnGameOver are broadcast at most once, after the last action. Returns the number of actions that succeeded.
+	 */
+	int32 ApplyActions(TConstArrayView<FMinesweeperAction> InActions, TArray<bool>& OutResults);
+
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper", Meta = (DisplayName = "Apply Actions"))
+		int32 K2_ApplyActions(const TArray<FMinesweeperAction>& Actions, TArray<bool>& Results) { return ApplyActions(Actions, Results); }
+
+
+	/** Reverts the last open, flag or chord made after the first click, including the move that ended the game. Returns false if there is nothing to undo. */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		bool Undo();
+
+	/** Makes the last undone action again. Any new action drops the actions that could still be redone. */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		bool Redo();
+
+	/** Undo and redo are only available on bounded boards while Minesweeper.UndoJournalMaxBytes is above 0. */
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE bool CanUndo() const { return UndoJournal.NumUndoEntries() > 0; }
+
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE bool CanRedo() const { return UndoJournal.NumRedoEntries() > 0; }
+
+	/** Returns how many actions were undone this game, so practice games can be told apart from clean ones. */
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE int32 GetUndoCount() const { return NumUndos; }
+
+	/** Returns the bytes held by the undo journal. The oldest actions are dropped past the Minesweeper.UndoJournalMaxBytes console variable. */
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE int64 GetUndoJournalSize() const { return UndoJournal.GetUsedBytes(); }
+
+
+	/**
+	 * Creates an independent copy of a bounded game to try moves on and throw away. Returns nullptr on unbounded boards.
+	 * Each fork is a new UObject, with its delegates and tickable registration, holding a full copy of the padded cells: (Width + 2) * (Height + 2) bytes,
+	 * 576 on an expert board and about 1 MB at 1000x1000. It skips the opening regions and undo journal, it flood fills instead, and its clock is stopped.
+	 * Lookahead that tries many moves should rewind one scratch game with SaveSnapshot and RestoreSnapshot, which share unchanged pages and allocate no objects.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		UMinesweeperGame* ForkGame(UObject* Outer = nullptr) const;
+
+	/** Saves the cells and counters of a bounded game. Pages matching the ones the snapshot already holds are kept, so saving over it only allocates the changed pages. */
+	bool SaveSnapshot(FMinesweeperGameSnapshot& InOutSnapshot) const;
+
+	/** Returns the game to a snapshot, switching to its difficulty if needed. Only the pages that differ are copied. The undo journal is cleared. */
+	bool RestoreSnapshot(const FMinesweeperGameSnapshot& InSnapshot);
+
+	/** Returns the bytes held by the board, its opening regions, undo journal and chunks. */
+	SIZE_T GetAllocatedSize() const;
+
 
 	UPROPERTY(BlueprintAssignable, Category = "Minesweeper")
 		FMinesweeperGameOverDelegate OnGameOver;
@@ -87,6 +199,15 @@ public:
 	//UPROPERTY(BlueprintAssignable, Category = "Minesweeper")
 		FMinesweeperGameOverDelegated OnGameOvered;
 
+	/** Broadcast after every action that changed a cell, or once after an ApplyActions batch that changed any. */
+	FMinesweeperBoardChangedDelegate OnBoardChanged;
+
+	/** Returns the grid indices of the cells changed since the last OnBoardChanged, so listeners can redraw only those. Cleared once the broadcast returns. */
+	FORCEINLINE TConstArrayView<int32> GetDirtyCellIndices() const { return DirtyCellIndices; }
+
+	/** True when any cell may have changed since the last OnBoardChanged: after setup, the first click, the end of the game, a snapshot restore, and on unbounded boards. */
+	FORCEINLINE bool AreAllCellsDirty() const { return bAllCellsDirty; }
+
 
 	UFUNCTION(BlueprintPure, Category = "Minesweeper")
 		FORCEINLINE FMinesweeperDifficulty GetDifficulty() const { return Difficulty; }
@@ -114,13 +235,13 @@ public:
 		FORCEINLINE bool IsGameActiveAndRunning() const { return IsActive && !IsPaused; }
 
 	UFUNCTION(BlueprintPure, Category = "Minesweeper")
-		FORCEINLINE bool HasGameStarted() const { return IsActive && GameTime > 0.0f; }
+		FORCEINLINE bool HasGameStarted() const { return IsActive && bHasStarted; }
 
 	UFUNCTION(BlueprintPure, Category = "Minesweeper")
-		FORCEINLINE bool IsGameOver() const { return !IsActive && GameTime > 0.0f; }
+		FORCEINLINE bool IsGameOver() const { return !IsActive && bHasStarted; }
 
 	UFUNCTION(BlueprintPure, Category = "Minesweeper")
-		FORCEINLINE bool HasWon() const { return GameTime > 0.0f && NumClosedCells == Difficulty.MineCount; }
+		FORCEINLINE bool HasWon() const { return !Difficulty.bUnbounded && bHasStarted && NumClosedCells == Difficulty.MineCount; }
 
 
 	UFUNCTION(BlueprintPure, Category = "Minesweeper")
@@ -130,6 +251,31 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Minesweeper")
 		FORCEINLINE int32 GetFlagsRemaining() const { return FlagsRemaining; }
 
+	/** Returns the number of chunks of an unbounded board held in memory. Memory grows with this count, not with the size of the board. */
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE int32 GetChunkCount() const { return ChunkedBoard.GetNumChunks(); }
+
+	/** Returns the resident, paged out and page file sizes of an unbounded board, capped by the Minesweeper.MaxResidentChunks console variable. */
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE FMinesweeperChunkStats GetChunkStats() const { return ChunkedBoard.GetStats(); }
+
+	/** Returns the number of cells that were revealed by the last successful TryOpenCell or TryChordCell call. */
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE int32 GetLastOpenedCellCount() const { return LastOpenedCellCount; }
+
+	/** Returns the number of openings, regions of cells without neighboring mines. -1 before the first click and on boards with lazy neighbor mine counts. */
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE int32 GetOpeningCount() const { return OpeningRegions.IsBuilt() ? OpeningRegions.Num() : INDEX_NONE; }
+
+
+	/** Sets how long no-guess generation may search for a solvable board on the first click before falling back to a normal board. */
+	UFUNCTION(BlueprintCallable, Category = "Minesweeper")
+		FORCEINLINE void SetNoGuessTimeBudget(const float InSeconds) { NoGuessTimeBudget = FMath::Max(InSeconds, 0.0f); }
+
+	/** Returns the statistics of the last no-guess board generation. */
+	UFUNCTION(BlueprintPure, Category = "Minesweeper")
+		FORCEINLINE FMinesweeperNoGuessStats GetLastNoGuessStats() const { return LastNoGuessStats; }
+
 
 protected:
 	//~ Begin FTickableGameObject Interface
@@ -145,17 +291,60 @@ protected:
 	int32 GridRandomSeed = 0;
 	FMinesweeperDifficulty Difficulty;
 
-	TMap<int32, TSharedRef<FMinesweeperCell>> CellMap;
+	float NoGuessTimeBudget = 0.5f;
+	FMinesweeperNoGuessStats LastNoGuessStats;
+
+	/**
+	 * Flat cell storage with a one cell sentinel ring around the grid, indexed by padded cell index (see CoordToPaddedIndex).
+	 * Sentinel cells stay opened and mine free so flood fills and neighbor counts never need bounds checks.
+	 */
+	TArray<FMinesweeperCell> Cells;
+
+	/** Width of a row in Cells, including the sentinel column on each side. */
+	int32 PaddedWidth = 0;
+
+	/** Changes whenever mines may have moved, so RestoreSnapshot knows when the opening regions still fit. */
+	uint32 BoardId = 0;
+
+	/** Cell storage of unbounded boards, Cells stays empty while it is used. */
+	FMinesweeperChunkedBoard ChunkedBoard;
+
+	/** Openings of the board, built at the first click once every neighbor mine count is known. */
+	FMinesweeperOpeningRegions OpeningRegions;
+
+	/** Cells changed by every action since the first click, see Undo. */
+	FMinesweeperUndoJournal UndoJournal;
+
+	/** Padded index deltas to the eight neighbors of a cell. */
+	int32 NeighborOffsets[8] = { };
+
+	/** Grid index deltas to the eight neighbors of a cell, matching NeighborOffsets. */
+	int32 IndexNeighborOffsets[8] = { };
 
 	bool IsActive = false;
 	bool IsPaused = false;
+
+	/** Set on games made by ForkGame, which are never ticked so discarded lookahead forks cost nothing until they are collected. */
+	bool bIsFork = false;
+
+	/** Set by the first click, so moves are accepted right after it, before the game clock has ticked, e.g. within one ApplyActions batch. */
+	bool bHasStarted = false;
+
+	/** Padded indices of the cells flagged before the first click, which clears them without visiting every cell. May hold cells unflagged since. */
+	TArray<int32> PreStartFlagCellIndices;
+
+	/** Cells of unbounded boards flagged before the first click, as PreStartFlagCellIndices. */
+	TArray<TPair<int64, int64>> PreStartUnboundedFlagCoords;
+
 	float GameTime = 0.0f;
 
 	int32 FlagsRemaining = 0;
 	int32 NumClosedCells = 0;
 	int32 NumOpenedCells = 0;
+	int32 LastOpenedCellCount = 0;
 
 	int32 TotalClicks = 0;
+	int32 NumUndos = 0;
 	int8 LastHighScoreRank = -1;
 
 
@@ -165,16 +354,163 @@ public:
 	int32 GridCoordToIndex(const FIntVector2& InCellCoord) const;
 	FIntVector2 GridIndexToCoord(const int32 InCellIndex) const;
 
-	int32 FindCellIndex(TSharedPtr<FMinesweeperCell> InCell) const;
+	int32 FindCellIndex(const FMinesweeperCell* InCell) const;
+
+	FMinesweeperCell* GetCell(const int32 InCellIndex);
+	const FMinesweeperCell* GetCell(const int32 InCellIndex) const;
+
+	/** 64-bit coordinate versions of the lookups above. They work on every board, but only unbounded boards have cells beyond the 32-bit range. */
+	bool IsValidGridCoord(const int64 InCellX, const int64 InCellY) const;
+
+	/** Returns the cell at the coordinate, creating its chunk on unbounded boards. Returns nullptr if the coordinate is invalid. */
+	FMinesweeperCell* GetCellAt(const int64 InCellX, const int64 InCellY);
+
+	/** Returns the cell at the coordinate without creating anything, nullptr if the coordinate is invalid or its chunk is not resident. */
+	const FMinesweeperCell* FindCellAt(const int64 InCellX, const int64 InCellY) const;
+
+	/** GetCellAt for display, returns nullptr instead of waiting while the chunk of an unbounded board is read back from disk. */
+	const FMinesweeperCell* TryGetCellAt(const int64 InCellX, const int64 InCellY);
+
+	/** Starts reading back the paged out chunks of an unbounded board that overlap the cell rect, bounds inclusive. */
+	void PrefetchCells(const int64 InMinCellX, const int64 InMinCellY, const int64 InMaxCellX, const int64 InMaxCellY);
+
+	/** Pages out the least recently used chunks of an unbounded board down to Minesweeper.MaxResidentChunks, cells from TryGetCellAt must not be kept across it. */
+	void TrimResidentChunks();
+
+
+	/** Range over every grid cell for range-based for loops, yielding the cell, its index and its coordinate. */
+	FORCEINLINE TMinesweeperCellRange<FMinesweeperCell> GetCells() { return TMinesweeperCellRange<FMinesweeperCell>(Cells.GetData(), Difficulty.Width, Difficulty.Height); }
+	FORCEINLINE TMinesweeperCellRange<const FMinesweeperCell> GetCells() const { return TMinesweeperCellRange<const FMinesweeperCell>(Cells.GetData(), Difficulty.Width, Difficulty.Height); }
+
+	/** Calls InFunc(Cell, CellIndex, CellCoord) for every grid cell in index order. */
+	template<typename FuncType>
+	FORCEINLINE void ForEachCell(FuncType&& InFunc)
+	{
+		for (const TMinesweeperCellRange<FMinesweeperCell>::FElement element : GetCells())
+		{
+			InFunc(element.Cell, element.Index, element.Coord);
+		}
+	}
+
+	template<typename FuncType>
+	FORCEINLINE void ForEachCell(FuncType&& InFunc) const
+	{
+		for (const TMinesweeperCellRange<const FMinesweeperCell>::FElement element : GetCells())
+		{
+			InFunc(element.Cell, element.Index, element.Coord);
+		}
+	}
+
+	/** Calls InFunc(NeighborCell, NeighborIndex) for each of the up to eight cells surrounding the cell index. */
+	template<typename FuncType>
+	FORCEINLINE void ForEachNeighbor(const int32 InCellIndex, FuncType&& InFunc)
+	{
+		if (!IsValidGridIndex(InCellIndex)) return;
+
+		const int32 paddedIndex = IndexToPaddedIndex(InCellIndex);
+		for (int32 i = 0; i < 8; ++i)
+		{
+			FMinesweeperCell& neighborCell = Cells[paddedIndex + NeighborOffsets[i]];
+			if (!neighborCell.bIsSentinel)
+			{
+				InFunc(neighborCell, InCellIndex + IndexNeighborOffsets[i]);
+			}
+		}
+	}
 
-	TSharedPtr<FMinesweeperCell> GetCell(const int32 InCellIndex);
-	TArray<TSharedRef<FMinesweeperCell>> GetNeighborCells(const int32 InCellIndex);
+	template<typename FuncType>
+	FORCEINLINE void ForEachNeighbor(const int32 InCellIndex, FuncType&& InFunc) const
+	{
+		if (!IsValidGridIndex(InCellIndex)) return;
+
+		const int32 paddedIndex = IndexToPaddedIndex(InCellIndex);
+		for (int32 i = 0; i < 8; ++i)
+		{
+			const FMinesweeperCell& neighborCell = Cells[paddedIndex + NeighborOffsets[i]];
+			if (!neighborCell.bIsSentinel)
+			{
+				InFunc(neighborCell, InCellIndex + IndexNeighborOffsets[i]);
+			}
+		}
+	}
 
 private:
-	void OpenCell(TSharedPtr<FMinesweeperCell> InCell, const int32 InCellIndex);
-	void OpenNeighbors(TSharedPtr<FMinesweeperCell> InCell, const int32 InCellIndex);
+	FORCEINLINE int32 CoordToPaddedIndex(const FIntVector2& InCellCoord) const { return ((InCellCoord.Y + 1) * PaddedWidth) + InCellCoord.X + 1; }
+	FORCEINLINE int32 IndexToPaddedIndex(const int32 InCellIndex) const { return InCellIndex + ((InCellIndex / Difficulty.Width) * 2) + PaddedWidth + 1; }
+	FORCEINLINE int32 PaddedIndexToIndex(const int32 InPaddedIndex) const { return (((InPaddedIndex / PaddedWidth) - 1) * Difficulty.Width) + (InPaddedIndex % PaddedWidth) - 1; }
 
-public:
-	void ForEachCell(TFunctionRef<void(TSharedRef<FMinesweeperCell> InCell, const int32 InCellIndex, const FVector2D InCellCoord)> InFunc);
+	/** Fills NeighborOffsets and IndexNeighborOffsets for the current grid width. */
+	void SetupNeighborOffsets();
+
+	/** Clears every cell and rebuilds the sentinel ring. */
+	void ResetCells();
+
+	/** Places every mine of a large board up front, so the first click only moves the few in its safe zone. Neighbor mine counts are left unknown until cells are opened. */
+	void PlaceLargeBoardMines();
+
+	/** Moves the mines inside the safe zone of a large board to random cells outside it. No neighbor mine count is known yet, so nothing else changes. */
+	void MoveMinesOutOfSafeZone(TConstArrayView<int32> InSafeCellIndices, FRandomStream& InRandStream);
+
+	/** Fills OutCellIndices with the sorted grid indices of the first click safe zone, shrunk if needed so every mine still fits. */
+	void GetSafeZoneCellIndices(const FIntVector2& InCellCoord, TArray<int32>& OutCellIndices) const;
+
+
+	bool TryOpenUnboundedCell(const int64 InCellX, const int64 InCellY);
+	bool TryFlagUnboundedCell(const int64 InCellX, const int64 InCellY);
+	bool TryChordUnboundedCell(const int64 InCellX, const int64 InCellY);
+
+	/** Ends the game if the last action opened a mine or every safe cell, then broadcasts OnBoardChanged and, if the game ended, OnGameOver. */
+	void CheckGameOver(const bool InHitMine);
+
+	void BroadcastGameOver(const bool InWon);
+	void NotifyBoardChanged();
+
+	/** Adds cells to the ones OnBoardChanged reports as changed, given their padded indices. */
+	void MarkCellDirty(const int32 InPaddedIndex);
+	void MarkCellsDirty(TConstArrayView<int32> InPaddedIndices);
+	void MarkAllCellsDirty();
+
+	/** Grid indices of the cells changed since OnBoardChanged was last broadcast, unused while bAllCellsDirty is set. */
+	TArray<int32> DirtyCellIndices;
+	bool bAllCellsDirty = true;
+
+	bool ApplyAction(const FMinesweeperAction& InAction);
+
+	/** Starts collecting the padded indices of the cells the following action changes, for the undo journal and the dirty cells. */
+	void BeginJournalEntry();
+
+	/** Marks the collected cells dirty and records them with how the action changed the counters, given their values before the action. */
+	void CommitJournalEntry(const FMinesweeperUndoJournal::ECellBit InChangedBit, const int32 InFlagsRemainingBefore, const int32 InNumOpenedCellsBefore, const bool InEndsGame);
+
+	/** True between BeginJournalEntry and CommitJournalEntry, while every cell opening path adds to ChangedCellIndices. */
+	bool bIsCollectingChangedCells = false;
+	TArray<int32> ChangedCellIndices;
+
+	/** True while ApplyActions runs, OnBoardChanged and OnGameOver are held back and the flags below record whether either is owed. */
+	bool bIsApplyingActions = false;
+	bool bBoardChangedInBatch = false;
+	bool bGameOverInBatch = false;
+
+
+	/** Explicit stack of padded cell indices used by OpenCell, kept between calls to avoid reallocating. */
+	TArray<int32> FloodFillStack;
+
+	/** Cells without neighboring mines found by each block of a parallel flood fill level, kept between calls to avoid reallocating. */
+	TArray<TArray<int32>> FloodFillBlockFrontiers;
+
+	/** Every cell opened by each block of a parallel flood fill level, only filled while recording the undo journal. */
+	TArray<TArray<int32>> FloodFillBlockOpenedCells;
+
+	/** Opens the cell at the padded index and flood fills outward through cells without neighboring mines. Returns the number of cells opened. */
+	int32 OpenCell(const int32 InPaddedIndex);
+
+	/** Counts and stores the neighboring mines of a cell whose count is still unknown. */
+	void ResolveNeighborMineCount(const int32 InPaddedIndex);
+
+	/**
+	 * Continues OpenCell from the cells in FloodFillStack one breadth first level at a time, expanding each level on worker threads.
+	 * Returns the number of cells opened.
+	 */
+	int32 ParallelFloodFill();
 
 };
@@ -0,0 +1,54 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MinesweeperDifficulty.h"
+#include "MinesweeperCell.h"
+
+
+
+
+/**
+ * Cell state and counters of a bounded game at one point in time, see UMinesweeperGame::SaveSnapshot.
+ * The padded cells are held in immutable pages shared between snapshots: copying a snapshot copies page pointers, and saving over it
+ * only allocates the pages whose cells changed, so a lookahead tree of snapshots costs the pages each branch touched.
+ */
+struct MINESWEEPERRUNTIME_API FMinesweeperGameSnapshot
+{
+	static constexpr int32 CellsPerPage = 4096;
+
+	typedef TArray<FMinesweeperCell> FPage;
+
+
+	FORCEINLINE bool IsValid() const { return NumCells > 0; }
+
+	FORCEINLINE int32 NumPages() const { return Pages.Num(); }
+
+	/** Returns the number of pages also held by another snapshot. */
+	int32 NumSharedPages() const;
+
+	/** Returns the bytes held by this snapshot, counting shared pages as if it owned them. */
+	SIZE_T GetAllocatedSize() const;
+
+
+private:
+	friend class UMinesweeperGame;
+
+	TArray<TSharedPtr<const FPage, ESPMode::ThreadSafe>> Pages;
+	int32 NumCells = 0;
+
+	FMinesweeperDifficulty Difficulty;
+
+	/** Mine layout the cells belong to, opening regions are only kept when restoring a snapshot of the same layout. */
+	uint32 BoardId = 0;
+
+	bool IsActive = false;
+	bool bHasStarted = false;
+	TArray<int32> PreStartFlagCellIndices;
+	float GameTime = 0.0f;
+	int32 FlagsRemaining = 0;
+	int32 NumClosedCells = 0;
+	int32 NumOpenedCells = 0;
+	int32 LastOpenedCellCount = 0;
+	int32 TotalClicks = 0;
+};
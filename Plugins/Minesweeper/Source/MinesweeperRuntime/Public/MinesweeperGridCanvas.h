@@ -3,6 +3,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/CanvasRenderTarget2D.h"
+#include "Engine/Canvas.h"
 #include "MinesweeperGridCanvas.generated.h"
 
 class UMinesweeperGame;
@@ -12,6 +13,10 @@ class UMinesweeperGame;
 
 /**
  * Canvas render target texture used to draw all grid cells. Inherit in blueprints to enable custom textures and cell draw size.
+ * Grids larger than MaxCanvasSize pixels are drawn through a view window that starts at the view origin cell, so drawing scales with the window and not the grid.
+ * RedrawChangedCells keeps the render target and draws only the cells that changed over it, UpdateResource clears it and draws every cell in view.
+ * Cell textures and digit glyphs are packed into a sprite atlas at runtime, so every cell in view is drawn in one triangle batch whatever sprites it shows.
+ * Digits are rasterized once per cell draw size in their neighbor mine count color, drawing a numbered cell does no text layout.
  */
 UCLASS()
 class MINESWEEPERRUNTIME_API UMinesweeperGridCanvas : public UCanvasRenderTarget2D
@@ -40,6 +45,19 @@ public:
 		void GridPositionToCellCoord(const FVector2D& GridPosition, int32& CellX, int32& CellY) const;
 
 
+	/** Returns the top left grid cell coordinate drawn by this canvas. */
+	UFUNCTION(BlueprintPure, Category = "MinesweeperGridCanvas")
+		void GetViewOrigin(int32& CellX, int32& CellY) const;
+
+	/** Sets the top left grid cell coordinate drawn by this canvas, clamped so the view stays on the grid. The canvas must be updated manually to reflect changes. */
+	UFUNCTION(BlueprintCallable, Category = "MinesweeperGridCanvas")
+		void SetViewOrigin(const int32 CellX, const int32 CellY);
+
+	/** Returns the number of cells drawn along each axis, the whole grid unless the grid is larger than MaxCanvasSize pixels. */
+	UFUNCTION(BlueprintPure, Category = "MinesweeperGridCanvas")
+		void GetViewCellCount(int32& CellCountX, int32& CellCountY) const;
+
+
 	/** Returns the draw size of each cell in pixels. */
 	UFUNCTION(BlueprintPure, Category = "MinesweeperGridCanvas")
 		FORCEINLINE float GetCellDrawSize() const { return CellDrawSize; }
@@ -49,23 +67,58 @@ public:
 		void SetCellDrawSize(const float InCellDrawSize);
 
 
-	/** Removes all hovered celvoid SetCellDrawSize(const float InCellDrawSize) { CellDrawSize = InCellDrawSize; }l drawing visualizations. */
+	/** Rebuilds the sprite atlas if its textures, font, digit size or colors changed, then clears the canvas and draws every cell in view. */
+	virtual void UpdateResource() override;
+
+	/** Redraws the cells the game reported as changed, and any whose hover state changed, over the current canvas. Call from UMinesweeperGame::OnBoardChanged. */
+	UFUNCTION(BlueprintCallable, Category = "MinesweeperGridCanvas")
+		void RedrawChangedCells();
+
+	/** Returns the number of cells drawn by the last canvas update, the whole view after UpdateResource. */
+	UFUNCTION(BlueprintPure, Category = "MinesweeperGridCanvas")
+		FORCEINLINE int32 GetLastDrawnCellCount() const { return LastDrawnCellCount; }
+
+	/** Returns the number of times this canvas was drawn, full updates and redraws of changed cells alike. */
+	UFUNCTION(BlueprintPure, Category = "MinesweeperGridCanvas")
+		FORCEINLINE int32 GetRedrawCount() const { return RedrawCount; }
+
+	/** Returns the render target holding every cell sprite, created by the first canvas update. */
+	FORCEINLINE UCanvasRenderTarget2D* GetSpriteAtlas() const { return SpriteAtlas; }
+
+
+	/** Removes all hovered cell drawing visualizations. */
 	UFUNCTION(BlueprintCallable, Category = "MinesweeperGridCanvas")
-		FORCEINLINE void ClearHoverCell() { HoverCellIndex = -1; }
+		void ClearHoverCell();
 
 	/** Sets the cell index that will be drawn as hovered by the mouse. -1 will skip drawing. */
 	UFUNCTION(BlueprintCallable, Category = "MinesweeperGridCanvas")
-		FORCEINLINE void SetHoverCellIndex(const int32 CellIndex) { HoverCellIndex = CellIndex; }
+		void SetHoverCellIndex(const int32 CellIndex);
 
 	/** Sets the cell coord that will be drawn as hovered by the mouse. -1 for CellX or CellY will skip drawing. */
 	UFUNCTION(BlueprintCallable, Category = "MinesweeperGridCanvas")
 		void SetHoverCellCoord(const int32 CellX, const int32 CellY); // FIntVector2 not supported in blueprints
 
+	/** Returns the hover outline texture, for widgets that draw the outline themselves instead of redrawing the canvas as the mouse moves. */
+	UFUNCTION(BlueprintPure, Category = "MinesweeperGridCanvas")
+		FORCEINLINE UTexture2D* GetHoverCellTexture() const { return HoverCellTexture; }
 
-	/**  */
+	/** Returns the hover outline color for a cell, the invalid color once it is opened. */
+	UFUNCTION(BlueprintPure, Category = "MinesweeperGridCanvas")
+		FLinearColor GetHoverCellColor(const int32 CellX, const int32 CellY) const;
+
+
+	/** Returns the color of a neighbor mine count digit. Resolved once into a palette, call InvalidateNeighborMineCountPalette when an override changes its colors. */
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "MinesweeperGridCanvas")
 		FSlateColor GetNeighborMineCountColor(const int32 MineCount);
 
+	/** Returns the neighbor mine count color from the cached palette, resolving the palette first if it is out of date. */
+	UFUNCTION(BlueprintPure, Category = "MinesweeperGridCanvas")
+		FLinearColor GetCachedNeighborMineCountColor(const int32 MineCount);
+
+	/** Drops the cached neighbor mine count palette so it is resolved from GetNeighborMineCountColor again, and redraws every cell on the next RedrawChangedCells. */
+	UFUNCTION(BlueprintCallable, Category = "MinesweeperGridCanvas")
+		void InvalidateNeighborMineCountPalette();
+
 
 	static FSlateColor DefaultNeighborMineCountColor(const int32 InMineCount);
 	static FSlateColor DefaultHoverCellValidColor() { return FLinearColor(0.0f, 1.0f, 0.0f, 1.0f); }
@@ -73,6 +126,12 @@ public:
 
 	static float DefaultCellDrawSize() { return 28.0f; }
 
+	/** Largest canvas width or height in pixels, larger grids are drawn through a view window. */
+	static int32 MaxCanvasSize() { return 2048; }
+
+	/** Returns the number of cells along each axis that a canvas for the grid size draws. */
+	static FIntVector2 ComputeViewCellCount(const FIntVector2& InGridSize, const float InCellDrawSize);
+
 
 	UFUNCTION(BlueprintCallable, Category = "MinesweeperGridCanvas")
 		FORCEINLINE void SetClosedCellTexture(UTexture2D* InClosedCellTexture) { if (InClosedCellTexture) { ClosedCellTexture = InClosedCellTexture; } }
@@ -131,7 +190,55 @@ protected:
 		FLinearColor HoverCellInvalidColor;
 
 
-	UPROPERTY() int32 HoverCellIndex = -1;
+	/** Coordinate of the cell drawn as hovered, kept as a coordinate because unbounded boards have no cell indices. */
+	FIntVector2 HoverCellCoord = FIntVector2(0, 0);
+	bool bHasHoverCell = false;
+
+	/** Top left grid cell coordinate drawn by this canvas. */
+	FIntVector2 ViewOrigin = FIntVector2(0, 0);
+
+	/** Cells to draw on the next RedrawChangedCells besides the ones the game reports, the old and new hover cells. */
+	TArray<FIntVector2> DirtyCellCoords;
+
+	/** True while RepaintCanvas draws only the dirty cells over the retained render target. */
+	bool bIsDrawingDirtyCells = false;
+
+	/** Set until the first full update, and whenever the view moves or resizes, RedrawChangedCells then updates the whole canvas. */
+	bool bNeedsFullRedraw = true;
+
+	int32 LastDrawnCellCount = 0;
+	int32 RedrawCount = 0;
+
+
+	/** Colors GetNeighborMineCountColor returns for 0 to 8 neighboring mines, resolved for NeighborMineCountPaletteClass. */
+	TArray<FLinearColor, TInlineAllocator<9>> NeighborMineCountPalette;
+	TWeakObjectPtr<const UClass> NeighborMineCountPaletteClass;
+
+	/** Resolves the neighbor mine count palette if it was invalidated or was resolved for another class, e.g. before a blueprint recompile. */
+	void UpdateNeighborMineCountPalette();
+
+
+	/** Render target holding every cell sprite, rebuilt when one of SpriteAtlasSources changes. */
+	UPROPERTY(Transient) UCanvasRenderTarget2D* SpriteAtlas = nullptr;
+
+	/** Textures and font the sprite atlas was last built from. */
+	UPROPERTY(Transient) TArray<UObject*> SpriteAtlasSources;
+
+	/** Cell draw size and neighbor mine count colors the atlas digits were last rasterized with, digits are drawn 1:1 with their color baked in. */
+	float SpriteAtlasDigitSize = 0.0f;
+	TArray<FLinearColor, TInlineAllocator<8>> SpriteAtlasDigitColors;
+
+	/** Cell and clear quads of the current update, kept between updates so redraws do not reallocate them. */
+	TArray<FCanvasUVTri> CellTriangles;
+	TArray<FCanvasUVTri> ClearTriangles;
+
+	/** Creates the sprite atlas, or redraws it if a cell texture, the cell font, the cell draw size or a digit color changed since it was built. */
+	void UpdateSpriteAtlasSources();
+
+	UFUNCTION() void UpdateSpriteAtlas(UCanvas* InCanvas, const int32 InWidth, const int32 InHeight);
+
+	/** Adds a cell to DirtyCellCoords if it is inside the view. */
+	void MarkCellDirty(const FIntVector2& InCellCoord);
 
 
 	/**  */
@@ -0,0 +1,63 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MinesweeperDifficulty.h"
+#include "MinesweeperNoGuessGenerator.generated.h"
+
+
+
+
+/**
+ * Statistics of the last no-guess board generation.
+ */
+USTRUCT(BlueprintType)
+struct MINESWEEPERRUNTIME_API FMinesweeperNoGuessStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** True if a board solvable without guessing was found, false if generation fell back to a normal board. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperNoGuessStats")
+		bool bSucceeded = false;
+
+	/** Number of candidate boards that were generated and run through the solver. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperNoGuessStats")
+		int32 CandidatesTried = 0;
+
+	/** Number of threads that evaluated candidates. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperNoGuessStats")
+		int32 NumWorkers = 0;
+
+	/** Wall clock time spent generating. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperNoGuessStats")
+		float Seconds = 0.0f;
+
+
+	float CandidatesPerSecond() const { return Seconds > 0.0f ? CandidatesTried / Seconds : 0.0f; }
+	float CandidatesPerSecondPerCore() const { return NumWorkers > 0 ? CandidatesPerSecond() / NumWorkers : 0.0f; }
+};
+
+
+
+
+/**
+ * Generates boards that can be solved from the first click by pure logic.
+ * Candidate boards are sampled and played with FMinesweeperSolver in parallel on the task graph until one passes.
+ */
+struct MINESWEEPERRUNTIME_API FMinesweeperNoGuessGenerator
+{
+	/**
+	 * Searches for a mine placement that is solvable without guessing when InFirstCellIndex is opened first.
+	 * Candidates are seeded from InSeed and the lowest passing candidate wins, so the result does not depend on thread timing.
+	 * @param InSafeCellIndices		Cells that must stay mine free, sorted ascending. Should contain the first cell and its neighbors.
+	 * @param InTimeBudgetSeconds	Time after which no new candidates are started.
+	 * @param OutMineCellIndices	Receives the mine cell indices of the passing board, left empty on failure.
+	 * @return True if a passing board was found within the time budget.
+	 */
+	static bool Generate(const FMinesweeperDifficulty& InDifficulty, const int32 InFirstCellIndex, TConstArrayView<int32> InSafeCellIndices,
+		const int32 InSeed, const float InTimeBudgetSeconds, TArray<int32>& OutMineCellIndices, FMinesweeperNoGuessStats& OutStats);
+
+	/** Returns true if the board can be fully opened from InFirstCellIndex without guessing. InMines holds one entry per cell, row major. */
+	static bool IsSolvableWithoutGuessing(const int32 InWidth, const int32 InHeight, TConstArrayView<bool> InMines, const int32 InFirstCellIndex);
+
+};
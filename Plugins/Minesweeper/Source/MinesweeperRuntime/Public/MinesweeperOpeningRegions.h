@@ -0,0 +1,52 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperCell;
+
+
+
+
+/**
+ * The openings of a board: connected regions of cells without neighboring mines, together with the numbered cells bordering them.
+ * Built once per board with union-find over a padded cell array (see UMinesweeperGame::GetCells), and stored as one flat list of
+ * padded indices per region, so opening a cell without neighboring mines reveals its region without a flood fill.
+ */
+struct MINESWEEPERRUNTIME_API FMinesweeperOpeningRegions
+{
+	/** Finds the regions of a padded cell array whose neighbor mine counts are all known. */
+	void Build(TConstArrayView<FMinesweeperCell> InCells, const int32 InPaddedWidth);
+
+	/** Drops every region. */
+	void Reset();
+
+
+	/** Returns the number of openings on the board, 0 before Build. */
+	FORCEINLINE int32 Num() const { return FMath::Max(RegionStarts.Num() - 1, 0); }
+	FORCEINLINE bool IsBuilt() const { return RegionStarts.Num() > 0; }
+
+	/** Returns the region of a cell without neighboring mines, INDEX_NONE for any other cell. */
+	FORCEINLINE int32 GetRegion(const int32 InPaddedIndex) const { return CellRegions[InPaddedIndex]; }
+
+	/** Returns the padded indices of the cells of a region and of its border, ascending. */
+	FORCEINLINE TConstArrayView<int32> GetRegionCells(const int32 InRegion) const
+	{
+		return MakeArrayView(RegionCells.GetData() + RegionStarts[InRegion], RegionStarts[InRegion + 1] - RegionStarts[InRegion]);
+	}
+
+	/** Opens every closed cell of a region and its border, adding their padded indices to OutOpenedCells if given. Returns the number of cells opened. */
+	int32 OpenRegion(TArrayView<FMinesweeperCell> InCells, const int32 InRegion, TArray<int32>* OutOpenedCells = nullptr) const;
+
+
+	SIZE_T GetAllocatedSize() const;
+
+
+private:
+	/** Region of every padded cell, INDEX_NONE for cells with neighboring mines, mines and sentinels. */
+	TArray<int32> CellRegions;
+
+	/** Cells of region N span [RegionStarts[N], RegionStarts[N + 1]) of RegionCells. */
+	TArray<int32> RegionStarts;
+	TArray<int32> RegionCells;
+};
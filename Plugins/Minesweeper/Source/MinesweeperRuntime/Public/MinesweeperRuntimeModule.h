@@ -9,6 +9,8 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogMinesweeperRuntime, All, All);
 
+DECLARE_STATS_GROUP(TEXT("Minesweeper"), STATGROUP_Minesweeper, STATCAT_Advanced);
+
 
 
 
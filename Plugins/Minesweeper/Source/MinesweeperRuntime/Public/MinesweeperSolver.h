@@ -0,0 +1,194 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MinesweeperSolver.generated.h"
+
+class UMinesweeperGame;
+
+
+
+
+/**
+ * The part of a Minesweeper board a player can see, indexed like UMinesweeperGame::GridCoordToIndex.
+ */
+struct MINESWEEPERRUNTIME_API FMinesweeperSolverBoard
+{
+	static constexpr int8 ClosedCell = -1;
+	static constexpr int8 FlaggedCell = -2;
+
+	int32 Width = 0;
+	int32 Height = 0;
+
+	/** Total number of mines on the board, as shown by the mine counter. */
+	int32 MineCount = 0;
+
+	/** The neighbor mine count of every opened cell, ClosedCell or FlaggedCell otherwise. */
+	TArray<int8> Cells;
+
+
+	FMinesweeperSolverBoard() { }
+	FMinesweeperSolverBoard(const int32 InWidth, const int32 InHeight, const int32 InMineCount) { Init(InWidth, InHeight, InMineCount); }
+
+
+	/** Resizes the board and closes every cell. */
+	void Init(const int32 InWidth, const int32 InHeight, const int32 InMineCount);
+
+	/** Copies the visible state of a game into this board, reusing the cell array. */
+	void CopyFromGame(const UMinesweeperGame& InGame);
+
+	static FMinesweeperSolverBoard FromGame(const UMinesweeperGame& InGame);
+
+
+	bool IsValid() const { return Width > 0 && Height > 0 && Cells.Num() == Width * Height; }
+	FORCEINLINE bool IsOpened(const int32 InCellIndex) const { return Cells[InCellIndex] >= 0; }
+	FORCEINLINE bool IsFlagged(const int32 InCellIndex) const { return Cells[InCellIndex] == FlaggedCell; }
+};
+
+
+
+
+/**
+ * Cells a solver proved safe or proved to be mines.
+ */
+USTRUCT(BlueprintType)
+struct MINESWEEPERRUNTIME_API FMinesweeperSolverResult
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Grid indices of closed cells that cannot contain a mine, sorted ascending. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperSolverResult")
+		TArray<int32> SafeCellIndices;
+
+	/** Grid indices of closed cells that must contain a mine, sorted ascending. Cells trusted as flagged mines are not repeated here. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperSolverResult")
+		TArray<int32> MineCellIndices;
+
+	/** False if the visible numbers contradict each other or the flags, in which case nothing was proven. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MinesweeperSolverResult")
+		bool bIsConsistent = true;
+};
+
+
+
+
+/**
+ * Deterministic Minesweeper logic solver. Only reads the visible state of a board and proves which closed cells are safe or mines using,
+ * in order of cost: single cell rules, subset reduction between overlapping cells, the global mine count and exhaustive enumeration
+ * of small independent frontier components.
+ * It can also compute the exact mine probability of every closed cell by weighting the arrangements of each frontier component
+ * with the number of ways the remaining mines fit into the cells away from the frontier.
+ * A solver keeps its scratch memory between calls, so reusing one instance to re-solve every click does not allocate.
+ */
+class MINESWEEPERRUNTIME_API FMinesweeperSolver
+{
+public:
+	/** Treat flagged cells as known mines. Faster, but wrong flags lead to wrong results. Otherwise flags are treated as closed cells. */
+	bool bTreatFlagsAsMines = false;
+
+	/** Largest frontier component that is solved by enumerating every mine arrangement. */
+	int32 MaxEnumerationCells = 24;
+
+	/** Maximum number of enumeration steps per component before the component is skipped. */
+	int32 MaxEnumerationSteps = 1 << 20;
+
+	/** Maximum number of enumeration steps per component when computing probabilities, which cannot skip components. */
+	int32 MaxProbabilityEnumerationSteps = 1 << 24;
+
+
+	/** Proves as many closed cells safe or mines as the visible state allows. Returns false if the board is invalid or inconsistent. */
+	bool Solve(const FMinesweeperSolverBoard& InBoard, FMinesweeperSolverResult& OutResult);
+
+	/**
+	 * Computes the exact probability that each cell holds a mine, given everything visible and a uniformly random placement of the rest.
+	 * OutProbabilities is indexed like the board cells. Opened cells are 0, trusted flags and proven mines are 1.
+	 * Returns false if the board is invalid, inconsistent or has a frontier component too large to enumerate.
+	 */
+	bool ComputeMineProbabilities(const FMinesweeperSolverBoard& InBoard, TArray<float>& OutProbabilities);
+
+
+private:
+	enum class ECellKnowledge : uint8 { Unknown, Safe, Mine, Opened, FlaggedMine };
+
+	/** Unknown neighbors of an opened cell and how many of them are mines. */
+	struct FConstraint
+	{
+		int32 CellIndex = INDEX_NONE;
+		int32 UnknownCells[8];
+		int32 NumUnknownCells = 0;
+		int32 NumMines = 0;
+
+		bool Contains(const int32 InCellIndex) const;
+	};
+
+	/** Constraints that a frontier cell takes part in. */
+	struct FFrontierCell
+	{
+		int32 CellIndex = INDEX_NONE;
+		int32 Constraints[8];
+		int32 NumConstraints = 0;
+		int32 ComponentIndex = INDEX_NONE;
+	};
+
+
+	const FMinesweeperSolverBoard* Board = nullptr;
+	TArray<ECellKnowledge> Knowledge;
+	int32 NumUnknownCells = 0;
+	int32 NumRemainingMines = 0;
+	bool bIsConsistent = true;
+
+	TArray<FConstraint> Constraints;
+	TArray<int32> ConstraintIndices;
+
+	TArray<FFrontierCell> FrontierCells;
+	TArray<int32> FrontierIndices;
+
+	/** Frontier cells grouped by component, component N spans [ComponentStarts[N], ComponentStarts[N + 1]) of ComponentFrontierCells. */
+	TArray<int32> ComponentStarts;
+	TArray<int32> ComponentFrontierCells;
+
+	/** Frontier cells of the component being enumerated, in enumeration order. */
+	TArrayView<const int32> ComponentCells;
+	TArray<int32> ConstraintAssignedMines;
+	TArray<int32> ConstraintUnassignedCells;
+	TArray<uint8> Assignment;
+	int32 NumAssignedMines = 0;
+	int32 NumEnumerationSteps = 0;
+	int32 EnumerationStepLimit = 0;
+
+	/** Number of arrangements of the enumerated component by mine count, and per cell the arrangements where it holds a mine, cell major. */
+	TArray<double> ComponentSolutions;
+	TArray<double> ComponentCellSolutions;
+
+	/** Per component solution counts kept for combining, and the convolutions used to leave one component out. */
+	TArray<TArray<double>> AllComponentSolutions;
+	TArray<TArray<double>> AllComponentCellSolutions;
+	TArray<TArray<double>> PrefixSolutions;
+	TArray<TArray<double>> SuffixSolutions;
+	TArray<double> OtherSolutions;
+	TArray<double> OutsideWeights;
+
+
+	template<typename FuncType>
+	FORCEINLINE void ForEachNeighbor(const int32 InCellIndex, FuncType&& InFunc) const;
+
+	void MarkCell(const int32 InCellIndex, const ECellKnowledge InKnowledge);
+	bool ResolveCells(const int32* InCellIndices, const int32 InNumCells, const int32 InNumMines);
+
+	bool Prepare(const FMinesweeperSolverBoard& InBoard);
+	bool ApplyRules();
+
+	void BuildConstraints();
+	bool ApplySingleCellRules();
+	bool ApplySubsetRules();
+	bool ApplyMineCountRule();
+	bool ApplyEnumeration();
+
+	void BuildComponents();
+	bool EnumerateComponent(const int32 InComponentIndex, const int32 InStepLimit);
+	void EnumerateCell(const int32 InDepth);
+	bool IsFeasibleMineCount(const int32 InComponentCells, const int32 InComponentMines) const;
+
+	/** Writes the convolution of two solution count arrays, rescaled so the largest entry is 1. */
+	static void Convolve(const TArray<double>& InA, const TArray<double>& InB, TArray<double>& OutResult);
+};
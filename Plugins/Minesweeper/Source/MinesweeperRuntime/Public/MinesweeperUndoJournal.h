@@ -0,0 +1,89 @@
+// Copyright 2022 Brad Monahan. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperCell;
+
+
+
+
+/**
+ * Append-only journal of the cells each game action changed, for unlimited undo and redo.
+ * An action only ever toggles one bit of the cells it touches, opened or flagged, so an entry is just the sorted padded indices
+ * of those cells packed as variable length runs. Applying an entry flips the bit back and forth, undo and redo both cost O(changed cells).
+ */
+struct MINESWEEPERRUNTIME_API FMinesweeperUndoJournal
+{
+	enum class ECellBit : uint8
+	{
+		Opened,
+		Flagged
+	};
+
+	struct FEntry
+	{
+		/** Position of the packed runs in the journal bytes. */
+		int32 FirstByte = 0;
+		int32 NumBytes = 0;
+
+		int32 NumCells = 0;
+		ECellBit ChangedBit = ECellBit::Opened;
+
+		/** Game counters the action changed, subtracted on undo and added back on redo. */
+		int32 FlagsRemainingDelta = 0;
+		int32 OpenedCellsDelta = 0;
+
+		/** True if the action ended the game. */
+		bool bEndedGame = false;
+	};
+
+
+	/** Drops every entry. */
+	void Reset();
+
+	/** Sets the memory cap, past which the oldest entries are dropped. 0 or less disables the journal. */
+	void SetMaxBytes(const int64 InMaxBytes);
+	FORCEINLINE int64 GetMaxBytes() const { return MaxBytes; }
+	FORCEINLINE bool IsEnabled() const { return MaxBytes > 0; }
+
+
+	/**
+	 * Appends an entry for the changed cells, dropping every entry that could have been redone. InOutCellIndices holds padded indices and is sorted in place.
+	 * The oldest entries are dropped while the journal is over its cap, which can include this one if it alone is larger.
+	 */
+	void Record(TArray<int32>& InOutCellIndices, const FEntry& InEntry);
+
+	/** Flips the cells of the last applied entry back and returns it, nullptr if there is nothing to undo. Their padded indices are added to OutCellIndices if given. */
+	const FEntry* Undo(TArrayView<FMinesweeperCell> InOutCells, TArray<int32>* OutCellIndices = nullptr);
+
+	/** Flips the cells of the next undone entry again and returns it, nullptr if there is nothing to redo. Their padded indices are added to OutCellIndices if given. */
+	const FEntry* Redo(TArrayView<FMinesweeperCell> InOutCells, TArray<int32>* OutCellIndices = nullptr);
+
+
+	FORCEINLINE int32 NumUndoEntries() const { return NumAppliedEntries; }
+	FORCEINLINE int32 NumRedoEntries() const { return Entries.Num() - NumAppliedEntries; }
+
+	/** Returns the number of bytes the journal counts against its cap. */
+	FORCEINLINE int64 GetUsedBytes() const { return (int64)Bytes.Num() + ((int64)Entries.Num() * sizeof(FEntry)); }
+
+	SIZE_T GetAllocatedSize() const;
+
+
+private:
+	TArray<FEntry> Entries;
+
+	/** Packed runs of every entry, back to back. */
+	TArray<uint8> Bytes;
+
+	/** Entries before this index are applied to the board, the rest have been undone. */
+	int32 NumAppliedEntries = 0;
+
+	int64 MaxBytes = 0;
+
+
+	void FlipCells(const FEntry& InEntry, TArrayView<FMinesweeperCell> InOutCells, TArray<int32>* OutCellIndices) const;
+
+	/** Drops the oldest entries until the journal is a quarter below its cap, so the bytes are not shifted on every record. */
+	void DropOldestEntries();
+};